@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "alloc.h"
+
+static const char* tag_names[MEM_TAG_COUNT] = {"block", "chain", "merkle", "snapshot", "replica"};
+
+typedef struct {
+    long long live_bytes;
+    long long peak_bytes;
+    long long live_allocations;
+    long long allocations;
+} TagCounters;
+
+static TagCounters counters[MEM_TAG_COUNT];
+
+#ifndef BLOCKCHAIN_NO_MEM_TRACKING
+
+// Keeps the user pointer aligned like malloc's, at the cost of a header of
+// sizeof(max_align_t) bytes (32 on x86_64) rather than 16
+typedef union {
+    struct {
+        size_t size;
+        int tag;
+    } info;
+    max_align_t align;
+} AllocHeader;
+
+static void account(int tag, long long bytes, int allocations) {
+    TagCounters* c = &counters[tag];
+    long long live = __atomic_add_fetch(&c->live_bytes, bytes, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&c->live_allocations, allocations, __ATOMIC_RELAXED);
+    if (allocations > 0) {
+        __atomic_add_fetch(&c->allocations, allocations, __ATOMIC_RELAXED);
+    }
+
+    long long peak = __atomic_load_n(&c->peak_bytes, __ATOMIC_RELAXED);
+    while (live > peak
+           && !__atomic_compare_exchange_n(&c->peak_bytes, &peak, live, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void* tracked_malloc(MemTag tag, size_t size) {
+    if (size > SIZE_MAX - sizeof(AllocHeader)) {
+        return NULL;
+    }
+    AllocHeader* header = (AllocHeader*)malloc(sizeof(AllocHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->info.size = size;
+    header->info.tag = tag;
+    account(tag, (long long)size, 1);
+    return header + 1;
+}
+
+void* tracked_calloc(MemTag tag, size_t count, size_t size) {
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total)) {
+        return NULL;
+    }
+    void* ptr = tracked_malloc(tag, total);
+    if (ptr != NULL) {
+        memset(ptr, 0, total);
+    }
+    return ptr;
+}
+
+void* tracked_realloc(MemTag tag, void* ptr, size_t size) {
+    if (ptr == NULL) {
+        return tracked_malloc(tag, size);
+    }
+    if (size > SIZE_MAX - sizeof(AllocHeader)) {
+        return NULL;
+    }
+
+    AllocHeader* header = (AllocHeader*)ptr - 1;
+    size_t old_size = header->info.size;
+    header = (AllocHeader*)realloc(header, sizeof(AllocHeader) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->info.size = size;
+    account(header->info.tag, (long long)size - (long long)old_size, 0);
+    return header + 1;
+}
+
+void tracked_free(void* ptr) {
+    if (ptr == NULL) return;
+
+    AllocHeader* header = (AllocHeader*)ptr - 1;
+    account(header->info.tag, -(long long)header->info.size, -1);
+    free(header);
+}
+
+// The bytes leave the old tag and count as one allocation of the new one;
+// the old tag's peak keeps the time they spent there
+void tracked_retag(void* ptr, MemTag tag) {
+    if (ptr == NULL) return;
+
+    AllocHeader* header = (AllocHeader*)ptr - 1;
+    account(header->info.tag, -(long long)header->info.size, -1);
+    header->info.tag = tag;
+    account(tag, (long long)header->info.size, 1);
+}
+
+#endif
+
+void get_mem_stats(MemTag tag, MemTagStats* stats) {
+    TagCounters* c = &counters[tag];
+    stats->live_bytes = __atomic_load_n(&c->live_bytes, __ATOMIC_RELAXED);
+    stats->peak_bytes = __atomic_load_n(&c->peak_bytes, __ATOMIC_RELAXED);
+    stats->live_allocations = __atomic_load_n(&c->live_allocations, __ATOMIC_RELAXED);
+    stats->allocations = __atomic_load_n(&c->allocations, __ATOMIC_RELAXED);
+}
+
+const char* mem_tag_name(MemTag tag) {
+    return tag >= 0 && tag < MEM_TAG_COUNT ? tag_names[tag] : "unknown";
+}
+
+void reset_mem_peaks() {
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        TagCounters* c = &counters[tag];
+        __atomic_store_n(&c->peak_bytes, __atomic_load_n(&c->live_bytes, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+        __atomic_store_n(&c->allocations, 0, __ATOMIC_RELAXED);
+    }
+}
+
+void print_mem_stats(FILE* output) {
+    fprintf(output, "%-10s %14s %14s %10s %12s\n", "tag", "live bytes", "peak bytes", "live", "allocations");
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        MemTagStats stats;
+        get_mem_stats((MemTag)tag, &stats);
+        fprintf(output, "%-10s %14lld %14lld %10lld %12lld\n", tag_names[tag],
+                stats.live_bytes, stats.peak_bytes, stats.live_allocations, stats.allocations);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef ALLOC_H
+#define ALLOC_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Tagged allocation wrappers for the core structures. Each allocation carries
+// a small header with its size and tag, so live bytes, peak bytes and
+// allocation counts are kept per tag. A pointer from tracked_malloc() must be
+// released with tracked_free(), whatever its tag. Building with
+// -DBLOCKCHAIN_NO_MEM_TRACKING maps the wrappers to the C allocator.
+
+typedef enum {
+    MEM_TAG_BLOCK,       // Block headers and transaction arrays
+    MEM_TAG_CHAIN,       // Blockchain structs and block pointer arrays
+    MEM_TAG_MERKLE,      // Transient Merkle tree nodes and levels
+    MEM_TAG_SNAPSHOT,    // Balance snapshots
+    MEM_TAG_REPLICA,     // Deep copies of blocks and chains held by other nodes
+    MEM_TAG_COUNT
+} MemTag;
+
+typedef struct {
+    long long live_bytes;        // Requested sizes, headers excluded
+    long long peak_bytes;
+    long long live_allocations;
+    long long allocations;       // Since start or the last reset_mem_peaks()
+} MemTagStats;
+
+#ifdef BLOCKCHAIN_NO_MEM_TRACKING
+
+#define tracked_malloc(tag, size) malloc(size)
+#define tracked_calloc(tag, count, size) calloc((count), (size))
+#define tracked_realloc(tag, ptr, size) realloc((ptr), (size))
+#define tracked_free(ptr) free(ptr)
+#define tracked_retag(ptr, tag) ((void)(ptr), (void)(tag))
+
+#else
+
+void* tracked_malloc(MemTag tag, size_t size);
+void* tracked_calloc(MemTag tag, size_t count, size_t size);
+void* tracked_realloc(MemTag tag, void* ptr, size_t size);  // An existing block keeps its tag
+void tracked_free(void* ptr);
+void tracked_retag(void* ptr, MemTag tag);  // Moves a live allocation to another tag
+
+#endif
+
+void get_mem_stats(MemTag tag, MemTagStats* stats);
+const char* mem_tag_name(MemTag tag);
+void reset_mem_peaks();    // Peaks restart from the live bytes, counts from zero
+void print_mem_stats(FILE* output);
+
+#endif
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+#include "amount.h"
+#include "logger.h"
+
+// Accepts "[-]digits[.digits]" with at most AMOUNT_DECIMALS decimals, e.g.
+// "50", "0.5" or "12.00000001", and rejects anything that would not fit
+int parse_amount(const char* text, amount_t* amount) {
+    const char* p = text;
+    int negative = 0;
+    if (*p == '-') {
+        negative = 1;
+        p++;
+    }
+    if (*p < '0' || *p > '9') {
+        return 0;
+    }
+
+    // Accumulate the magnitude as a negative number so that AMOUNT_MIN fits
+    amount_t value = 0;
+    for (; *p >= '0' && *p <= '9'; p++) {
+        if (__builtin_mul_overflow(value, 10, &value) || __builtin_sub_overflow(value, *p - '0', &value)) {
+            return 0;
+        }
+    }
+
+    int decimals = 0;
+    if (*p == '.') {
+        p++;
+        if (*p < '0' || *p > '9') {
+            return 0;
+        }
+        for (; *p >= '0' && *p <= '9'; p++) {
+            if (++decimals > AMOUNT_DECIMALS
+                || __builtin_mul_overflow(value, 10, &value) || __builtin_sub_overflow(value, *p - '0', &value)) {
+                return 0;
+            }
+        }
+    }
+    if (*p != '\0') {
+        return 0;
+    }
+
+    for (; decimals < AMOUNT_DECIMALS; decimals++) {
+        if (__builtin_mul_overflow(value, 10, &value)) {
+            return 0;
+        }
+    }
+    if (!negative && value == AMOUNT_MIN) {
+        return 0;
+    }
+
+    *amount = negative ? value : -value;
+    return 1;
+}
+
+// Canonical form: no leading zeros, no trailing decimal zeros and no decimal
+// point for whole amounts, so whole amounts print exactly as plain integers
+char* format_amount(amount_t amount, char* output, size_t size) {
+    uint64_t magnitude = amount < 0 ? (uint64_t)0 - (uint64_t)amount : (uint64_t)amount;
+    uint64_t whole = magnitude / AMOUNT_SCALE;
+    uint64_t fraction = magnitude % AMOUNT_SCALE;
+
+    if (fraction == 0) {
+        snprintf(output, size, "%s%llu", amount < 0 ? "-" : "", (unsigned long long)whole);
+        return output;
+    }
+
+    int digits = AMOUNT_DECIMALS;
+    while (fraction % 10 == 0) {
+        fraction /= 10;
+        digits--;
+    }
+    snprintf(output, size, "%s%llu.%0*llu", amount < 0 ? "-" : "",
+             (unsigned long long)whole, digits, (unsigned long long)fraction);
+    return output;
+}
+
+int amount_add(amount_t a, amount_t b, amount_t* result) {
+    return __builtin_add_overflow(a, b, result) ? BC_ERR_OVERFLOW : BC_OK;
+}
+
+int amount_sub(amount_t a, amount_t b, amount_t* result) {
+    return __builtin_sub_overflow(a, b, result) ? BC_ERR_OVERFLOW : BC_OK;
+}
+
+// Exact sum of the values, or BC_ERR_OVERFLOW if it does not fit an amount_t.
+// Each value is split into its unsigned 32-bit halves, which are summed in
+// separate 64-bit lanes alongside a count of negative values; the loop only
+// uses adds, masks and logical shifts, so it vectorizes even on SSE2. The
+// halves cannot wrap within a chunk of 2^31 values.
+int sum_amounts_checked(const amount_t* values, long count, amount_t* total) {
+    __int128 sum = 0;
+
+    for (long start = 0; start < count; start += 1L << 31) {
+        long end = count - start > (1L << 31) ? start + (1L << 31) : count;
+        const uint64_t* bits = (const uint64_t*)values;
+        uint64_t high = 0, low = 0, negatives = 0;
+
+        for (long i = start; i < end; i++) {
+            high += bits[i] >> 32;
+            low += bits[i] & 0xffffffffu;
+            negatives += bits[i] >> 63;
+        }
+        sum += ((__int128)high << 32) + (__int128)low - ((__int128)negatives << 64);
+    }
+
+    if (sum < AMOUNT_MIN || sum > AMOUNT_MAX) {
+        return BC_ERR_OVERFLOW;
+    }
+    *total = (amount_t)sum;
+    return BC_OK;
+}
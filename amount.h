@@ -0,0 +1,25 @@
+#ifndef AMOUNT_H
+#define AMOUNT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Amounts are signed 64-bit fixed point: 1 DA = AMOUNT_SCALE units, i.e.
+// eight decimals, up to about 92 billion DA
+typedef int64_t amount_t;
+
+#define AMOUNT_SCALE 100000000LL
+#define AMOUNT_DECIMALS 8
+#define AMOUNT_MIN INT64_MIN
+#define AMOUNT_MAX INT64_MAX
+#define AMOUNT_STRING_SIZE 32   // Longest formatted amount with its NUL
+
+#define DA(n) ((amount_t)(n) * AMOUNT_SCALE)
+
+int parse_amount(const char* text, amount_t* amount);  // 1 if valid and in range, 0 otherwise
+char* format_amount(amount_t amount, char* output, size_t size);
+int amount_add(amount_t a, amount_t b, amount_t* result);  // BC_OK or BC_ERR_OVERFLOW
+int amount_sub(amount_t a, amount_t b, amount_t* result);  // BC_OK or BC_ERR_OVERFLOW
+int sum_amounts_checked(const amount_t* values, long count, amount_t* total);
+
+#endif
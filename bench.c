@@ -0,0 +1,632 @@
+// bench.c - microbenchmarks for the core hashing, Merkle, parsing and chain operations
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "blockchain.h"
+#include "block.h"
+#include "merkle.h"
+#include "transaction.h"
+#include "utils.h"
+#include "query.h"
+#include "columnar.h"
+#include "codec.h"
+#include "thread_pool.h"
+#include "sealer.h"
+#include "loadgen.h"
+#include "signature.h"
+
+#define MAX_RESULTS 128
+
+typedef struct {
+    char name[64];
+    long param;
+    long iterations;
+    double ns_per_op;
+    double ops_per_sec;
+    double allocs_per_op;
+    double bytes_per_op;
+} BenchResult;
+
+typedef void (*BenchFn)(void* ctx, long iterations);
+
+static BenchResult results[MAX_RESULTS];
+static int result_count = 0;
+static double min_time = 0.25;   // seconds per benchmark
+static const char* filter = NULL;
+static volatile long bench_sink;  // Keeps results of pure loops alive
+
+// Allocation counters, fed by the --wrap=malloc/calloc/realloc linker wrappers
+// so that only allocations made by the code under test are counted. The sealer
+// and pool threads allocate too, so updates are atomic as in alloc.c.
+static long alloc_count = 0;
+static long alloc_bytes = 0;
+
+static void count_allocation(size_t size) {
+    __atomic_add_fetch(&alloc_count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&alloc_bytes, (long)size, __ATOMIC_RELAXED);
+}
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    count_allocation(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    count_allocation(count * size);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    count_allocation(size);
+    return __real_realloc(ptr, size);
+}
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void run_bench(const char* name, long param, BenchFn fn, void* ctx) {
+    if (filter != NULL && strstr(name, filter) == NULL) return;
+    if (result_count >= MAX_RESULTS) return;
+
+    // Warm up, then grow the iteration count until a run lasts at least min_time
+    fn(ctx, 1);
+
+    long iterations = 1;
+    double elapsed = 0;
+    long allocs = 0, bytes = 0;
+    for (;;) {
+        long start_count = __atomic_load_n(&alloc_count, __ATOMIC_RELAXED);
+        long start_bytes = __atomic_load_n(&alloc_bytes, __ATOMIC_RELAXED);
+        double start = now_seconds();
+        fn(ctx, iterations);
+        elapsed = now_seconds() - start;
+        allocs = __atomic_load_n(&alloc_count, __ATOMIC_RELAXED) - start_count;
+        bytes = __atomic_load_n(&alloc_bytes, __ATOMIC_RELAXED) - start_bytes;
+
+        if (elapsed >= min_time || iterations >= (1L << 30)) break;
+
+        long next = elapsed > 0 ? (long)(iterations * (min_time / elapsed) * 1.2) : iterations * 100;
+        if (next <= iterations) next = iterations * 2;
+        if (next > iterations * 100) next = iterations * 100;
+        iterations = next;
+    }
+
+    BenchResult* r = &results[result_count++];
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    r->param = param;
+    r->iterations = iterations;
+    r->ns_per_op = elapsed * 1e9 / iterations;
+    r->ops_per_sec = iterations / elapsed;
+    r->allocs_per_op = (double)allocs / iterations;
+    r->bytes_per_op = (double)bytes / iterations;
+
+    printf("%-28s %10ld %12ld %14.1f %14.1f %10.2f %12.1f\n",
+           r->name, r->param, r->iterations, r->ns_per_op, r->ops_per_sec,
+           r->allocs_per_op, r->bytes_per_op);
+    fflush(stdout);
+}
+
+// ---- Fixtures ----
+
+static void make_transaction(int i, char* output, size_t size) {
+    static const char* names[] = {"Alice", "Bob", "Charlie", "Dave", "Eve", "Frank", "Grace", "Heidi"};
+    snprintf(output, size, "%s sends %d DA to %s", names[i % 8], 1 + (i * 37) % 1000, names[(i + 3) % 8]);
+}
+
+// Build a chain of `length` blocks with full bodies, hashing each block once
+static Blockchain* build_chain(long length) {
+    Blockchain* blockchain = init_blockchain();
+
+    for (long i = 1; i < length; i++) {
+        Block* last = blockchain->blocks[blockchain->length - 1];
+        Block* block = create_block(blockchain->length, last->current_hash);
+
+        for (int j = 0; j < MAX_TRANSACTIONS; j++) {
+            char input[256];
+            make_transaction((int)(i * MAX_TRANSACTIONS + j), input, sizeof(input));
+            parse_transaction(input, &block->transactions[block->transaction_count++]);
+        }
+        calculate_block_hash(block);
+        add_block(blockchain, block);
+    }
+
+    return blockchain;
+}
+
+// ---- Benchmarks ----
+
+typedef struct {
+    char* input;
+} HashCtx;
+
+static void bench_sha256(void* ctx, long iterations) {
+    HashCtx* c = (HashCtx*)ctx;
+    char output[65];
+    for (long i = 0; i < iterations; i++) {
+        sha256_hash(c->input, output);
+    }
+}
+
+// Header hash with the cached prefix midstate, and with the cache dropped so
+// that both compressions run
+static void bench_hash_block_header(void* ctx, long iterations) {
+    Block* block = (Block*)ctx;
+    char output[65];
+    for (long i = 0; i < iterations; i++) {
+        hash_block_header(block, output);
+    }
+}
+
+static void bench_hash_block_header_cold(void* ctx, long iterations) {
+    Block* block = (Block*)ctx;
+    char output[65];
+    for (long i = 0; i < iterations; i++) {
+        block->has_midstate = 0;
+        hash_block_header(block, output);
+    }
+}
+
+typedef struct {
+    Block* block;
+    int flags;
+    unsigned char encoded[BODY_MAX_ENCODED_SIZE];
+    size_t size;
+} BodyCtx;
+
+static void bench_encode_block_body(void* ctx, long iterations) {
+    BodyCtx* c = (BodyCtx*)ctx;
+    for (long i = 0; i < iterations; i++) {
+        encode_block_body(c->block, c->flags, c->encoded, sizeof(c->encoded), &c->size);
+    }
+}
+
+static void bench_decode_block_body(void* ctx, long iterations) {
+    BodyCtx* c = (BodyCtx*)ctx;
+    for (long i = 0; i < iterations; i++) {
+        decode_block_body(c->encoded, c->size, c->block);
+    }
+}
+
+typedef struct {
+    char (*transactions)[TX_STRING_SIZE];
+    int count;
+} MerkleCtx;
+
+static void bench_build_merkle_tree(void* ctx, long iterations) {
+    MerkleCtx* c = (MerkleCtx*)ctx;
+    for (long i = 0; i < iterations; i++) {
+        MerkleNode* root = build_merkle_tree(c->transactions, c->count);
+        free_merkle_tree(root);
+    }
+}
+
+static void bench_get_merkle_root(void* ctx, long iterations) {
+    Block* block = (Block*)ctx;
+    for (long i = 0; i < iterations; i++) {
+        get_merkle_root(block);
+    }
+}
+
+static void bench_parse_transaction(void* ctx, long iterations) {
+    const char* input = (const char*)ctx;
+    Transaction tx;
+    for (long i = 0; i < iterations; i++) {
+        parse_transaction(input, &tx);
+    }
+}
+
+// Generated transaction, Zipf sender over `param` accounts
+static void bench_next_transaction(void* ctx, long iterations) {
+    LoadGenerator* generator = (LoadGenerator*)ctx;
+    char output[256];
+    for (long i = 0; i < iterations; i++) {
+        next_transaction(generator, output, sizeof(output));
+    }
+}
+
+typedef struct {
+    const Transaction** txs;
+    int count;
+    KeyRegistry* registry;
+    ThreadPool* pool;
+    int* results;
+} SignatureCtx;
+
+// One op checks `param` signed transactions with one call each
+static void bench_verify_signatures_single(void* ctx, long iterations) {
+    SignatureCtx* c = (SignatureCtx*)ctx;
+    long valid = 0;
+    for (long i = 0; i < iterations; i++) {
+        for (int j = 0; j < c->count; j++) {
+            valid += verify_transaction_signature(c->txs[j], c->registry);
+        }
+    }
+    bench_sink = valid;
+}
+
+// One op checks the same `param` transactions as one batch split across the pool
+static void bench_verify_signatures_batch(void* ctx, long iterations) {
+    SignatureCtx* c = (SignatureCtx*)ctx;
+    long failures = 0;
+    for (long i = 0; i < iterations; i++) {
+        failures += verify_signatures_batch(c->txs, c->count, 1, c->registry, c->results, c->pool);
+    }
+    bench_sink = failures;
+}
+
+typedef struct {
+    long length;
+    Block* block;
+} AddBlockCtx;
+
+// Appends `length` block pointers to a fresh chain; one op is one add_block()
+static void bench_add_block(void* ctx, long iterations) {
+    AddBlockCtx* c = (AddBlockCtx*)ctx;
+    long remaining = iterations;
+    while (remaining > 0) {
+        Blockchain* blockchain = init_blockchain();
+        long n = remaining < c->length ? remaining : c->length;
+        for (long i = 0; i < n; i++) {
+            add_block(blockchain, c->block);
+        }
+        blockchain->length = 1;  // The appended pointers are all the shared fixture block
+        free_blockchain(blockchain);
+        remaining -= n;
+    }
+}
+
+// Parse a full block and seal it, in line or on the sealer thread; chains of
+// `length` blocks, one op is one block
+static void ingest_blocks(long length, long iterations, int async) {
+    long remaining = iterations;
+    while (remaining > 0) {
+        Blockchain* blockchain = init_blockchain();
+        Sealer* sealer = async ? create_sealer(blockchain, 0) : NULL;
+        long n = remaining < length ? remaining : length;
+        for (long i = 0; i < n; i++) {
+            // The sealer owns the chain; only the in-line path may read the tip
+            Block* block = async ? create_block(0, "")
+                                 : create_block(blockchain->length, blockchain->blocks[blockchain->length - 1]->current_hash);
+            for (int j = 0; j < MAX_TRANSACTIONS; j++) {
+                char input[256];
+                make_transaction((int)(i * MAX_TRANSACTIONS + j), input, sizeof(input));
+                append_transaction(block, input);
+            }
+            if (async) {
+                sealer_submit(sealer, block);
+            } else {
+                calculate_block_hash(block);
+                add_block(blockchain, block);
+            }
+        }
+        free_sealer(sealer);
+        free_blockchain(blockchain);
+        remaining -= n;
+    }
+}
+
+static void bench_ingest_blocks(void* ctx, long iterations) {
+    ingest_blocks(*(long*)ctx, iterations, 0);
+}
+
+static void bench_ingest_blocks_async(void* ctx, long iterations) {
+    ingest_blocks(*(long*)ctx, iterations, 1);
+}
+
+static void bench_deep_copy_blockchain(void* ctx, long iterations) {
+    Blockchain* blockchain = (Blockchain*)ctx;
+    for (long i = 0; i < iterations; i++) {
+        free_blockchain(deep_copy_blockchain(blockchain));
+    }
+}
+
+static void bench_verify_blockchain(void* ctx, long iterations) {
+    Blockchain* blockchain = (Blockchain*)ctx;
+    for (long i = 0; i < iterations; i++) {
+        verify_blockchain_integrity(blockchain);
+    }
+}
+
+// Account lookups for an account absent from every block: with the Bloom
+// filter against the plain strcmp scan it replaces
+static void bench_find_account_blocks(void* ctx, long iterations) {
+    Blockchain* blockchain = (Blockchain*)ctx;
+    int index;
+    for (long i = 0; i < iterations; i++) {
+        find_account_blocks(blockchain, "Mallory", &index, 1);
+    }
+}
+
+static void bench_scan_account_blocks(void* ctx, long iterations) {
+    Blockchain* blockchain = (Blockchain*)ctx;
+    for (long i = 0; i < iterations; i++) {
+        int found = 0;
+        for (int b = 0; b < blockchain->length; b++) {
+            Block* block = blockchain->blocks[b];
+            for (int t = 0; t < block->transaction_count; t++) {
+                if (strcmp(block->transactions[t].sender, "Mallory") == 0
+                    || strcmp(block->transactions[t].receiver, "Mallory") == 0) {
+                    found++;
+                    break;
+                }
+            }
+        }
+        bench_sink = found;
+    }
+}
+
+typedef struct {
+    Blockchain* blockchain;
+    ThreadPool* pool;
+} QueryCtx;
+
+// Amount-range scan over every body, which the Bloom filters cannot prune
+static void bench_run_tx_query(void* ctx, long iterations) {
+    QueryCtx* c = (QueryCtx*)ctx;
+    TxQuery query;
+    init_tx_query(&query);
+    query.min_amount = DA(500);
+    for (long i = 0; i < iterations; i++) {
+        run_tx_query(c->blockchain, &query, c->pool, NULL, NULL, NULL);
+    }
+}
+
+// Total volume from the columns against the same sum over the blocks
+static void bench_sum_amounts(void* ctx, long iterations) {
+    TxColumns* columns = (TxColumns*)ctx;
+    for (long i = 0; i < iterations; i++) {
+        amount_t total = 0;
+        sum_amounts(columns, INT64_MIN, INT64_MAX, &total);
+        bench_sink = (long)total;
+    }
+}
+
+// Time-bounded total: masked chunks fed to the checked kernel
+static void bench_sum_amounts_window(void* ctx, long iterations) {
+    TxColumns* columns = (TxColumns*)ctx;
+    int64_t middle = columns->rows > 0 ? columns->timestamps[columns->rows / 2] : 0;
+    for (long i = 0; i < iterations; i++) {
+        amount_t total = 0;
+        sum_amounts(columns, INT64_MIN, middle, &total);
+        bench_sink = (long)total;
+    }
+}
+
+static void bench_sum_amounts_blocks(void* ctx, long iterations) {
+    Blockchain* blockchain = (Blockchain*)ctx;
+    for (long i = 0; i < iterations; i++) {
+        amount_t total = 0;
+        for (int b = 0; b < blockchain->length; b++) {
+            amount_t block_total;
+            sum_block_amounts(blockchain->blocks[b], &block_total);
+            amount_add(total, block_total, &total);
+        }
+        bench_sink = (long)total;
+    }
+}
+
+static void bench_sum_by_account(void* ctx, long iterations) {
+    TxColumns* columns = (TxColumns*)ctx;
+    amount_t sent[64], received[64];
+    for (long i = 0; i < iterations; i++) {
+        sum_by_account(columns, sent, received);
+    }
+    bench_sink = (long)sent[0];
+}
+
+// ---- Output ----
+
+static int write_json(const char* path, long max_length) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return 0;
+    }
+
+    fprintf(file, "{\n  \"config\": {\"min_time_s\": %.3f, \"max_chain_length\": %ld},\n", min_time, max_length);
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (int i = 0; i < result_count; i++) {
+        BenchResult* r = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"param\": %ld, \"iterations\": %ld, "
+                      "\"ns_per_op\": %.3f, \"ops_per_sec\": %.3f, "
+                      "\"allocs_per_op\": %.3f, \"bytes_per_op\": %.3f}%s\n",
+                r->name, r->param, r->iterations, r->ns_per_op, r->ops_per_sec,
+                r->allocs_per_op, r->bytes_per_op, i + 1 < result_count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    int ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+static void usage(const char* program) {
+    printf("Usage: %s [--json FILE] [--min-time SECONDS] [--max-len N] [--filter NAME]\n", program);
+    printf("  --json FILE        also write the results as JSON\n");
+    printf("  --min-time SECONDS minimum measured time per benchmark (default 0.25)\n");
+    printf("  --max-len N        longest chain for copy/verify benchmarks, 10..1000000 (default 100000)\n");
+    printf("  --filter NAME      only run benchmarks whose name contains NAME\n");
+}
+
+int main(int argc, char** argv) {
+    const char* json_path = NULL;
+    long max_length = 100000;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            min_time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-len") == 0 && i + 1 < argc) {
+            max_length = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+    if (max_length < 10) max_length = 10;
+    if (max_length > 1000000) max_length = 1000000;
+
+    printf("%-28s %10s %12s %14s %14s %10s %12s\n",
+           "benchmark", "param", "iterations", "ns/op", "ops/s", "allocs/op", "bytes/op");
+
+    // sha256_hash over inputs of increasing size
+    for (int size = 64; size <= 4096; size *= 4) {
+        HashCtx ctx;
+        ctx.input = (char*)malloc(size + 1);
+        memset(ctx.input, 'a', size);
+        ctx.input[size] = '\0';
+        run_bench("sha256_hash", size, bench_sha256, &ctx);
+        free(ctx.input);
+    }
+
+    // build_merkle_tree at varying transaction counts
+    for (int count = 1; count <= 4096; count *= 4) {
+        MerkleCtx ctx;
+        ctx.count = count;
+        ctx.transactions = malloc(count * sizeof(*ctx.transactions));
+        for (int i = 0; i < count; i++) {
+            make_transaction(i, ctx.transactions[i], sizeof(ctx.transactions[i]));
+        }
+        run_bench("build_merkle_tree", count, bench_build_merkle_tree, &ctx);
+        free(ctx.transactions);
+    }
+
+    // get_merkle_root on blocks up to the per-block transaction limit
+    for (int count = 1; count <= MAX_TRANSACTIONS; count = count < 5 ? count + 4 : count + 5) {
+        Block* block = create_block(1, "0");
+        for (int i = 0; i < count; i++) {
+            char input[256];
+            make_transaction(i, input, sizeof(input));
+            parse_transaction(input, &block->transactions[block->transaction_count++]);
+        }
+        run_bench("get_merkle_root", count, bench_get_merkle_root, block);
+        free_block(block);
+    }
+
+    // Body codec on a full block; param is the encoded size in bytes
+    for (int flags = BODY_CODEC_PLAIN; flags <= BODY_CODEC_DEFLATE; flags++) {
+        BodyCtx ctx;
+        ctx.block = create_block(1, "0");
+        ctx.flags = flags;
+        for (int i = 0; i < MAX_TRANSACTIONS; i++) {
+            char input[256];
+            make_transaction(i, input, sizeof(input));
+            parse_transaction(input, &ctx.block->transactions[ctx.block->transaction_count++]);
+        }
+        encode_block_body(ctx.block, flags, ctx.encoded, sizeof(ctx.encoded), &ctx.size);
+        run_bench(flags == BODY_CODEC_PLAIN ? "encode_block_body" : "encode_block_body_deflate",
+                  (long)ctx.size, bench_encode_block_body, &ctx);
+        run_bench(flags == BODY_CODEC_PLAIN ? "decode_block_body" : "decode_block_body_deflate",
+                  (long)ctx.size, bench_decode_block_body, &ctx);
+        free_block(ctx.block);
+    }
+
+    Block* header_block = create_block(1, "5feceb66ffc86f38d952786c6d696c79c2dbc239dd4e91b46729d73a27fb57e9");
+    calculate_block_hash(header_block);
+    run_bench("hash_block_header", 0, bench_hash_block_header, header_block);
+    run_bench("hash_block_header_cold", 0, bench_hash_block_header_cold, header_block);
+    free_block(header_block);
+
+    run_bench("parse_transaction", 0, bench_parse_transaction, "Alice sends 50 DA to Bob");
+
+    LoadConfig load;
+    init_load_config(&load);
+    for (load.accounts = 100; load.accounts <= 100000; load.accounts *= 100) {
+        LoadGenerator* generator = create_load_generator(&load);
+        run_bench("next_transaction", load.accounts, bench_next_transaction, generator);
+        free_load_generator(generator);
+    }
+
+    ThreadPool* pool = create_thread_pool(0);
+
+    // Signature checks one call at a time vs in batches, from a block up
+    KeyPair signers[8];
+    KeyRegistry* registry = create_key_registry();
+    for (int i = 0; i < 8; i++) {
+        Transaction tx;
+        char input[256];
+        generate_keypair(&signers[i]);
+        make_transaction(i, input, sizeof(input));
+        parse_transaction(input, &tx);
+        register_account_key(registry, tx.sender, signers[i].public_key);
+    }
+    for (int count = MAX_TRANSACTIONS; count <= 1000; count *= 10) {
+        Transaction* signed_txs = (Transaction*)malloc(count * sizeof(Transaction));
+        const Transaction** txs = (const Transaction**)malloc(count * sizeof(Transaction*));
+        int* verified = (int*)malloc(count * sizeof(int));
+        for (int i = 0; i < count; i++) {
+            char input[256];
+            make_transaction(i, input, sizeof(input));
+            parse_transaction(input, &signed_txs[i]);
+            signed_txs[i].nonce = i + 1;
+            sign_transaction(&signed_txs[i], &signers[i % 8]);
+            txs[i] = &signed_txs[i];
+        }
+        SignatureCtx signature_ctx = {txs, count, registry, pool, verified};
+        run_bench("verify_signatures_single", count, bench_verify_signatures_single, &signature_ctx);
+        run_bench("verify_signatures_batch", count, bench_verify_signatures_batch, &signature_ctx);
+        free(signed_txs);
+        free(txs);
+        free(verified);
+    }
+    for (int i = 0; i < 8; i++) {
+        free_keypair(&signers[i]);
+    }
+    free_key_registry(registry);
+
+    // Chain-level operations at lengths 10 .. max_length
+    for (long length = 10; length <= max_length; length *= 10) {
+        Block* block = create_block(1, "0");
+        AddBlockCtx add_ctx = {length, block};
+        run_bench("add_block", length, bench_add_block, &add_ctx);
+        free_block(block);
+        run_bench("ingest_blocks", length, bench_ingest_blocks, &length);
+        run_bench("ingest_blocks_async", length, bench_ingest_blocks_async, &length);
+
+        if (filter != NULL && strstr("deep_copy_blockchain", filter) == NULL
+            && strstr("verify_blockchain_integrity", filter) == NULL
+            && strstr("find_account_blocks", filter) == NULL
+            && strstr("scan_account_blocks", filter) == NULL
+            && strstr("run_tx_query", filter) == NULL
+            && strstr("sum_amounts_window", filter) == NULL
+            && strstr("sum_amounts_blocks", filter) == NULL
+            && strstr("sum_by_account", filter) == NULL) {
+            continue;
+        }
+
+        Blockchain* blockchain = build_chain(length);
+        run_bench("deep_copy_blockchain", length, bench_deep_copy_blockchain, blockchain);
+        run_bench("verify_blockchain_integrity", length, bench_verify_blockchain, blockchain);
+        run_bench("find_account_blocks", length, bench_find_account_blocks, blockchain);
+        run_bench("scan_account_blocks", length, bench_scan_account_blocks, blockchain);
+        QueryCtx query_ctx = {blockchain, pool};
+        run_bench("run_tx_query", length, bench_run_tx_query, &query_ctx);
+
+        TxColumns* columns = build_tx_columns(blockchain);
+        run_bench("sum_amounts", length, bench_sum_amounts, columns);
+        run_bench("sum_amounts_window", length, bench_sum_amounts_window, columns);
+        run_bench("sum_amounts_blocks", length, bench_sum_amounts_blocks, blockchain);
+        run_bench("sum_by_account", length, bench_sum_by_account, columns);
+        free_tx_columns(columns);
+        free_blockchain(blockchain);
+    }
+
+    free_thread_pool(pool);
+
+    if (json_path != NULL && !write_json(json_path, max_length)) {
+        fprintf(stderr, "Could not write %s\n", json_path);
+        return 1;
+    }
+
+    return 0;
+}
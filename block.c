@@ -1,32 +1,148 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <time.h>
+#include <openssl/sha.h>
 #include "block.h"
 #include "utils.h"
 #include "merkle.h"
+#include "metrics.h"
+#include "logger.h"
+#include "alloc.h"
 
-void calculate_block_hash(Block* block) {
-    // First calculate the Merkle root
-    get_merkle_root(block);
+static void put_le32(unsigned char* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+static void put_le64(unsigned char* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+// A header hash field: 64 lower-case hex digits, or the "0" previous hash of
+// the genesis block, which is encoded as zeros. Returns 0 for anything else.
+static int put_hash(unsigned char* out, const char* hex) {
+    if (strcmp(hex, "0") == 0) {
+        memset(out, 0, 32);
+        return 1;
+    }
+    for (int i = 0; i < 64; i++) {
+        if (!((hex[i] >= '0' && hex[i] <= '9') || (hex[i] >= 'a' && hex[i] <= 'f'))) {
+            return 0;
+        }
+    }
+    return hex[64] == '\0' && hex_to_bytes(hex, out, 32);
+}
+
+static int encode_header_prefix(const Block* block, unsigned char prefix[BLOCK_HEADER_PREFIX_SIZE]) {
+    put_le32(prefix, BLOCK_HEADER_VERSION);
+    put_le32(prefix + 4, (uint32_t)block->index);
+    put_le64(prefix + 8, (uint64_t)(int64_t)block->timestamp);
+    memset(prefix + 48, 0, 16);
+    return put_hash(prefix + 16, block->previous_hash);
+}
+
+// Returns BC_OK, or BC_ERR_FORMAT if a hash field is malformed
+int encode_block_header(const Block* block, unsigned char header[BLOCK_HEADER_SIZE]) {
+    if (!encode_header_prefix(block, header) || !put_hash(header + BLOCK_HEADER_PREFIX_SIZE, block->merkle_root)) {
+        return BC_ERR_FORMAT;
+    }
+    return BC_OK;
+}
+
+// The one routine that hashes a header, for sealing and for verification.
+// The block is only read: the midstate cached by calculate_block_hash() is
+// copied when the encoded prefix still matches. Returns BC_OK,
+// BC_ERR_FORMAT if a hash field is malformed, or BC_ERR_NOMEM.
+int hash_block_header(const Block* block, char output[65]) {
+    unsigned char header[BLOCK_HEADER_SIZE];
+    output[0] = '\0';
+    if (encode_block_header(block, header) != BC_OK) {
+        return BC_ERR_FORMAT;
+    }
+
+    EVP_MD_CTX* sha256 = EVP_MD_CTX_new();
+    if (sha256 == NULL) {
+        return BC_ERR_NOMEM;
+    }
+    int ok;
+    if (block->has_midstate && memcmp(block->header_prefix, header, BLOCK_HEADER_PREFIX_SIZE) == 0) {
+        METRIC_INC(METRIC_MIDSTATE_HITS);
+        ok = EVP_MD_CTX_copy_ex(sha256, block->header_midstate) == 1;
+    } else {
+        ok = EVP_DigestInit_ex(sha256, EVP_sha256(), NULL) == 1
+          && EVP_DigestUpdate(sha256, header, BLOCK_HEADER_PREFIX_SIZE) == 1;
+    }
+
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+    ok = ok && EVP_DigestUpdate(sha256, header + BLOCK_HEADER_PREFIX_SIZE, BLOCK_HEADER_SIZE - BLOCK_HEADER_PREFIX_SIZE) == 1
+            && EVP_DigestFinal_ex(sha256, hash, NULL) == 1;
+    EVP_MD_CTX_free(sha256);
+    if (!ok) {
+        return BC_ERR_NOMEM;
+    }
+    METRIC_INC(METRIC_HASHES_COMPUTED);
+
+    bytes_to_hex(hash, SHA256_DIGEST_LENGTH, output);
+    return BC_OK;
+}
+
+// Keep the SHA-256 state after the header prefix while the prefix is
+// unchanged, so resealing after a Merkle root change runs one compression
+static int cache_header_midstate(Block* block) {
+    unsigned char prefix[BLOCK_HEADER_PREFIX_SIZE];
+    if (!encode_header_prefix(block, prefix)) {
+        return BC_ERR_FORMAT;
+    }
+    if (block->has_midstate && memcmp(block->header_prefix, prefix, BLOCK_HEADER_PREFIX_SIZE) == 0) {
+        return BC_OK;
+    }
+
+    if (block->header_midstate == NULL) {
+        block->header_midstate = EVP_MD_CTX_new();
+        if (block->header_midstate == NULL) {
+            return BC_ERR_NOMEM;
+        }
+    }
+    block->has_midstate = EVP_DigestInit_ex(block->header_midstate, EVP_sha256(), NULL) == 1
+                       && EVP_DigestUpdate(block->header_midstate, prefix, BLOCK_HEADER_PREFIX_SIZE) == 1;
+    if (!block->has_midstate) {
+        return BC_ERR_NOMEM;
+    }
+    memcpy(block->header_prefix, prefix, BLOCK_HEADER_PREFIX_SIZE);
+    return BC_OK;
+}
+
+int calculate_block_hash(Block* block) {
+    METRIC_TIMER_START(timer);
     
-    // Concatenate the block data
-    char buffer[1024];
-    sprintf(buffer, "%d%ld%s%s", 
-            block->index, 
-            block->timestamp, 
-            block->previous_hash, 
-            block->merkle_root);
+    // First calculate the Merkle root
+    int status = get_merkle_root(block);
+    if (status != BC_OK) {
+        return status;
+    }
+    if (!is_block_pruned(block)) {
+        build_block_bloom(block);
+    }
     
-    // Calculate the block hash
-    sha256_hash(buffer, block->current_hash);
+    status = cache_header_midstate(block);
+    if (status == BC_OK) {
+        status = hash_block_header(block, block->current_hash);
+    }
+    METRIC_TIMER_STOP(timer, METRIC_HIST_BLOCK_HASH);
+    return status;
 }
 
 Block* create_block(int index, const char* previous_hash) {
-    Block* block = (Block*)malloc(sizeof(Block));
+    Block* block = (Block*)tracked_malloc(MEM_TAG_BLOCK, sizeof(Block));
     if (block == NULL) {
-        printf("Memory allocation error\n");
-        exit(1);
+        return NULL;
+    }
+    
+    block->transactions = (Transaction*)tracked_malloc(MEM_TAG_BLOCK, MAX_TRANSACTIONS * sizeof(Transaction));
+    if (block->transactions == NULL) {
+        tracked_free(block);
+        return NULL;
     }
     
     block->index = index;
@@ -38,54 +154,144 @@ Block* create_block(int index, const char* previous_hash) {
     
     memset(block->current_hash, 0, 65);
     memset(block->merkle_root, 0, 65);
+    bloom_clear(&block->accounts);
+    block->header_midstate = NULL;
+    block->has_midstate = 0;
     
     return block;
 }
 
-Block* add_transaction(Block* block, const char* input) {
-    if (block->transaction_count >= 10) {
-        printf("Transaction limit reached.\n");
-        return block;
+void build_block_bloom(Block* block) {
+    bloom_clear(&block->accounts);
+    for (int i = 0; i < block->transaction_count; i++) {
+        bloom_add(&block->accounts, block->transactions[i].sender);
+        bloom_add(&block->accounts, block->transactions[i].receiver);
+    }
+}
+
+// 1 if the account sends or receives in this block. The filter answers most
+// lookups; a pruned block whose filter matches is reported as touching the
+// account since its body can no longer rule it out.
+int block_touches_account(const Block* block, const char* account) {
+    if (!bloom_might_contain(&block->accounts, account)) {
+        METRIC_INC(METRIC_BLOOM_SKIPS);
+        return 0;
+    }
+    if (is_block_pruned(block)) {
+        return 1;
+    }
+
+    for (int i = 0; i < block->transaction_count; i++) {
+        if (strcmp(block->transactions[i].sender, account) == 0
+            || strcmp(block->transactions[i].receiver, account) == 0) {
+            return 1;
+        }
+    }
+    METRIC_INC(METRIC_BLOOM_FALSE_POSITIVES);
+    return 0;
+}
+
+// Total of the transaction amounts; the amounts are gathered so the checked
+// kernel can sum them as one vector
+int sum_block_amounts(const Block* block, amount_t* total) {
+    amount_t amounts[MAX_TRANSACTIONS];
+    int count = is_block_pruned(block) ? 0 : block->transaction_count;
+    for (int i = 0; i < count; i++) {
+        amounts[i] = block->transactions[i].amount;
+    }
+    return sum_amounts_checked(amounts, count, total);
+}
+
+// Parse and store a transaction without rehashing the block; batch producers
+// call calculate_block_hash() once the block is full.
+int append_transaction(Block* block, const char* input) {
+    if (is_block_pruned(block)) {
+        log_message(BC_LOG_WARN, "Block #%d has been pruned and no longer accepts transactions.", block->index);
+        METRIC_INC(METRIC_TX_REJECTED);
+        return BC_ERR_PRUNED;
+    }
+
+    if (block->transaction_count >= MAX_TRANSACTIONS) {
+        log_message(BC_LOG_WARN, "Transaction limit reached.");
+        METRIC_INC(METRIC_TX_REJECTED);
+        return BC_ERR_BLOCK_FULL;
     }
 
     Transaction tx;
     if (!parse_transaction(input, &tx)) {
-        printf("Invalid transaction format. Expected: 'A sends 50 DA to B'\n");
-        return block;
+        log_message(BC_LOG_WARN, "Invalid transaction format. Expected: 'A sends 50 DA to B'");
+        return BC_ERR_INVALID_TX;
     }
 
     block->transactions[block->transaction_count++] = tx;
-    calculate_block_hash(block);
-    return block;
+    METRIC_INC(METRIC_TX_ADDED);
+    return BC_OK;
 }
 
-void display_block(Block* block) {
-    char time_str[30];
-    struct tm *timeinfo;
-    timeinfo = localtime(&block->timestamp);
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", timeinfo);
-    
-    printf("\n=== BLOCK #%d ===\n", block->index);
-    printf("Timestamp: %s\n", time_str);
-    printf("Previous Hash: %s\n", block->previous_hash);
-    printf("Merkle Root: %s\n", block->merkle_root);
-    printf("Current Hash: %s\n", block->current_hash);
-    printf("Transactions (%d):\n", block->transaction_count);
-    for (int i = 0; i < block->transaction_count; i++) {
-        Transaction* tx = &block->transactions[i];
-        printf("  %d. %s sends %d DA to %s\n", i+1, tx->sender, tx->amount, tx->receiver);
+int add_transaction(Block* block, const char* input) {
+    int status = append_transaction(block, input);
+    if (status != BC_OK) {
+        return status;
+    }
+    return calculate_block_hash(block);
+}
+
+Block* copy_block_header(Block* original) {
+    Block* copy = (Block*)tracked_malloc(MEM_TAG_REPLICA, sizeof(Block));
+    if (copy == NULL) {
+        return NULL;
     }
     
-    printf("================\n");
+    memcpy(copy, original, sizeof(Block));
+    copy->transactions = NULL;
+    copy->header_midstate = NULL;  // Owned by the original; the copy rebuilds its own when sealed
+    copy->has_midstate = 0;
+    return copy;
 }
 
 Block* deep_copy_block(Block* original) {
-    Block* copy = (Block*)malloc(sizeof(Block));
+    Block* copy = copy_block_header(original);
     if (copy == NULL) {
-        printf("Memory allocation error\n");
-        exit(1);
+        return NULL;
+    }
+    
+    if (!is_block_pruned(original)) {
+        copy->transactions = (Transaction*)tracked_malloc(MEM_TAG_REPLICA, MAX_TRANSACTIONS * sizeof(Transaction));
+        if (copy->transactions == NULL) {
+            tracked_free(copy);
+            return NULL;
+        }
+        memcpy(copy->transactions, original->transactions, MAX_TRANSACTIONS * sizeof(Transaction));
     }
     
-    memcpy(copy, original, sizeof(Block));
     return copy;
 }
+
+// The midstate is an OpenSSL allocation outside tracked_malloc(), so it is
+// only kept while the block is being filled and resealed
+void release_header_midstate(Block* block) {
+    EVP_MD_CTX_free(block->header_midstate);
+    block->header_midstate = NULL;
+    block->has_midstate = 0;
+}
+
+// Drop the transaction payload but keep the header (index, timestamp, hashes
+// and transaction_count) so the block still links and verifies. The header
+// can no longer change, so its midstate goes too.
+void prune_block(Block* block) {
+    tracked_free(block->transactions);
+    block->transactions = NULL;
+    release_header_midstate(block);
+}
+
+int is_block_pruned(const Block* block) {
+    return block->transactions == NULL;
+}
+
+void free_block(Block* block) {
+    if (block == NULL) return;
+    
+    EVP_MD_CTX_free(block->header_midstate);
+    tracked_free(block->transactions);
+    tracked_free(block);
+}
@@ -2,23 +2,59 @@
 #define BLOCK_H
 
 #include <time.h>
+#include <openssl/evp.h>
 #include "transaction.h"
+#include "bloom.h"
+
+#define MAX_TRANSACTIONS 10
+
+// Canonical header preimage, little-endian and fixed width:
+//   0  version (u32)   4  index (u32)   8  timestamp (i64)
+//  16  previous hash (32 bytes)        48  reserved, zero (16 bytes)
+//  64  Merkle root (32 bytes)
+// The first 64 bytes fill exactly one SHA-256 block, so rehashing after a
+// change to the trailing fields only runs the final compression. Hash fields
+// must be 64 lower-case hex digits, except the genesis "0" previous hash,
+// which is encoded as zeros; any other value cannot be hashed.
+#define BLOCK_HEADER_VERSION 1
+#define BLOCK_HEADER_PREFIX_SIZE 64
+#define BLOCK_HEADER_SIZE 96
 
 typedef struct Block {
     int index;                     
     time_t timestamp;              
-    Transaction transactions[10];    
+    Transaction* transactions;     // Block body, NULL once the block has been pruned
     int transaction_count;         
     char previous_hash[65];       
     char current_hash[65];
     char merkle_root[65];        
+    BloomFilter accounts;          // Senders and receivers of the body, rebuilt when the block is hashed
+
+    // SHA-256 state after the header prefix, valid while the encoded prefix
+    // still equals header_prefix. Set when the block is sealed, released by
+    // add_block() once it is linked (a tip refilled later caches it again),
+    // never shared with copies.
+    unsigned char header_prefix[BLOCK_HEADER_PREFIX_SIZE];
+    EVP_MD_CTX* header_midstate;
+    int has_midstate;
 } Block;
 
-// Block operations
+// Block operations; functions returning int return a BlockchainStatus (logger.h),
+// functions returning a pointer return NULL on allocation failure
 Block* create_block(int index, const char* previous_hash);
-Block* add_transaction(Block* block, const char* input);
-void calculate_block_hash(Block* block);
-void display_block(Block* block);
+int add_transaction(Block* block, const char* input);
+int append_transaction(Block* block, const char* input);
+int calculate_block_hash(Block* block);
+int encode_block_header(const Block* block, unsigned char header[BLOCK_HEADER_SIZE]);
+int hash_block_header(const Block* block, char output[65]);
+void build_block_bloom(Block* block);
+int block_touches_account(const Block* block, const char* account);
+int sum_block_amounts(const Block* block, amount_t* total);  // BC_OK or BC_ERR_OVERFLOW
 Block* deep_copy_block(Block* original);
+Block* copy_block_header(Block* original);
+void release_header_midstate(Block* block);
+void prune_block(Block* block);
+int is_block_pruned(const Block* block);
+void free_block(Block* block);
 
 #endif
@@ -2,146 +2,261 @@
 #include <stdlib.h>
 #include <string.h>
 #include "blockchain.h"
+#include "snapshot.h"
 #include "utils.h"
+#include "metrics.h"
+#include "merkle.h"
+#include "logger.h"
+#include "alloc.h"
 
 Blockchain* init_blockchain() {
-    Blockchain* blockchain = (Blockchain*)malloc(sizeof(Blockchain));
+    Blockchain* blockchain = (Blockchain*)tracked_malloc(MEM_TAG_CHAIN, sizeof(Blockchain));
     if (blockchain == NULL) {
-        printf("Memory allocation error\n");
-        exit(1);
+        return NULL;
     }
 
     blockchain->capacity = 10;
     blockchain->length = 0;
-    blockchain->blocks = (Block**)malloc(blockchain->capacity * sizeof(Block*));
+    blockchain->pruned_height = 0;
+    blockchain->snapshot = NULL;
+    blockchain->blocks = (Block**)tracked_malloc(MEM_TAG_CHAIN, blockchain->capacity * sizeof(Block*));
     if (blockchain->blocks == NULL) {
-        printf("Memory allocation error\n");
-        free(blockchain);
-        exit(1);
+        tracked_free(blockchain);
+        return NULL;
     }
 
     // Create the genesis block properly
     Block* genesis = create_block(0, "0");  // "0" for no previous hash
-    Transaction genesis_tx = {"System", "Network", 0};
+    if (genesis == NULL) {
+        tracked_free(blockchain->blocks);
+        tracked_free(blockchain);
+        return NULL;
+    }
+    Transaction genesis_tx = {.sender = "System", .receiver = "Network", .amount = 0};
     genesis->transactions[genesis->transaction_count++] = genesis_tx;
-    calculate_block_hash(genesis);
+    if (calculate_block_hash(genesis) != BC_OK) {
+        free_block(genesis);
+        tracked_free(blockchain->blocks);
+        tracked_free(blockchain);
+        return NULL;
+    }
 
     blockchain->blocks[blockchain->length++] = genesis;
+    release_header_midstate(genesis);
 
     return blockchain;
 }
 
-void add_block(Blockchain* blockchain, Block* block) {
+int add_block(Blockchain* blockchain, Block* block) {
     if (blockchain->length >= blockchain->capacity) {
-        blockchain->capacity *= 2;
-        blockchain->blocks = (Block**)realloc(blockchain->blocks, blockchain->capacity * sizeof(Block*));
-        if (blockchain->blocks == NULL) {
-            printf("Memory allocation error\n");
-            exit(1);
+        Block** blocks = (Block**)tracked_realloc(MEM_TAG_CHAIN, blockchain->blocks, blockchain->capacity * 2 * sizeof(Block*));
+        if (blocks == NULL) {
+            return BC_ERR_NOMEM;
         }
+        blockchain->blocks = blocks;
+        blockchain->capacity *= 2;
     }
     
     blockchain->blocks[blockchain->length++] = block;
+    release_header_midstate(block);
+    METRIC_INC(METRIC_BLOCKS_SEALED);
+    return BC_OK;
 }
 
 Blockchain* deep_copy_blockchain(Blockchain* original) {
-    Blockchain* copy = (Blockchain*)malloc(sizeof(Blockchain));
+    Blockchain* copy = (Blockchain*)tracked_malloc(MEM_TAG_REPLICA, sizeof(Blockchain));
     if (copy == NULL) {
-        printf("Memory allocation error\n");
-        exit(1);
+        return NULL;
     }
     
     copy->capacity = original->capacity;
-    copy->length = original->length;
-    copy->blocks = (Block**)malloc(copy->capacity * sizeof(Block*));
+    copy->length = 0;
+    copy->pruned_height = original->pruned_height;
+    copy->snapshot = NULL;
+    copy->blocks = (Block**)tracked_malloc(MEM_TAG_REPLICA, copy->capacity * sizeof(Block*));
     if (copy->blocks == NULL) {
-        printf("Memory allocation error\n");
-        free(copy);
-        exit(1);
+        tracked_free(copy);
+        return NULL;
+    }
+    
+    if (original->snapshot != NULL) {
+        copy->snapshot = copy_snapshot(original->snapshot);
+        if (copy->snapshot == NULL) {
+            free_blockchain(copy);
+            return NULL;
+        }
     }
     
     for (int i = 0; i < original->length; i++) {
         copy->blocks[i] = deep_copy_block(original->blocks[i]);
+        if (copy->blocks[i] == NULL) {
+            free_blockchain(copy);
+            return NULL;
+        }
+        copy->length++;
     }
     
     return copy;
 }
 
+// Account a chain built by the loaders under another tag, e.g. MEM_TAG_REPLICA
+// for one received from a peer. As in deep_copy_blockchain(), the snapshot
+// stays under MEM_TAG_SNAPSHOT.
+void retag_blockchain(Blockchain* blockchain, MemTag tag) {
+    for (int i = 0; i < blockchain->length; i++) {
+        tracked_retag(blockchain->blocks[i]->transactions, tag);
+        tracked_retag(blockchain->blocks[i], tag);
+    }
+    tracked_retag(blockchain->blocks, tag);
+    tracked_retag(blockchain, tag);
+}
+
 void free_blockchain(Blockchain* blockchain) {
     if (blockchain == NULL) return;
     
     for (int i = 0; i < blockchain->length; i++) {
-        free(blockchain->blocks[i]);
+        free_block(blockchain->blocks[i]);
     }
-    free(blockchain->blocks);
-    free(blockchain);
+    free_snapshot(blockchain->snapshot);
+    tracked_free(blockchain->blocks);
+    tracked_free(blockchain);
 }
 
-void calculate_blockchain_hash(Blockchain* blockchain, char* output) {
-    char buffer[10240] = {0};
-    char temp[65];
+int calculate_blockchain_hash(Blockchain* blockchain, char* output) {
+    // Sized to the chain: a fixed buffer overflowed past ~150 blocks
+    char* buffer = (char*)malloc((size_t)blockchain->length * 64 + 1);
+    if (buffer == NULL) {
+        output[0] = '\0';
+        return BC_ERR_NOMEM;
+    }
     
+    size_t offset = 0;
     for (int i = 0; i < blockchain->length; i++) {
-        strcat(buffer, blockchain->blocks[i]->current_hash);
+        memcpy(buffer + offset, blockchain->blocks[i]->current_hash, 64);
+        offset += strnlen(blockchain->blocks[i]->current_hash, 64);
     }
+    buffer[offset] = '\0';
     
     sha256_hash(buffer, output);
+    free(buffer);
+    return BC_OK;
 }
 
-int verify_blockchain_integrity(Blockchain* blockchain) {
-    for (int i = 1; i < blockchain->length; i++) {
+static int verify_chain(Blockchain* blockchain, int from) {
+    for (int i = from; i < blockchain->length; i++) {
         Block* current_block = blockchain->blocks[i];
         Block* previous_block = blockchain->blocks[i-1];
         
         // Vérifier la liaison entre les blocs
         if (strcmp(current_block->previous_hash, previous_block->current_hash) != 0) {
-            printf("Blockchain integrity compromised at block %d!\n", i);
+            log_message(BC_LOG_WARN, "Blockchain integrity compromised at block %d!", i);
             return 0;
         }
         
+        // Recalculer le Merkle root pour vérifier les transactions, sans
+        // modifier la racine enregistrée dans l'en-tête
+        if (!is_block_pruned(current_block)) {
+            char merkle_root[65];
+            if (compute_merkle_root(current_block, merkle_root) != BC_OK) {
+                log_message(BC_LOG_ERROR, "Could not rebuild the Merkle root of block %d.", i);
+                return 0;
+            }
+            if (strcmp(merkle_root, current_block->merkle_root) != 0) {
+                log_message(BC_LOG_WARN, "Merkle root mismatch in block %d! Transactions have been tampered with.", i);
+                return 0;
+            }
+        }
+        
         // Revérifier le hash du bloc actuel
         char calculated_hash[65];
-        char buffer[1024];
-        
-        // Recalculer le Merkle root pour vérifier les transactions
-        char original_merkle_root[65];
-        strcpy(original_merkle_root, current_block->merkle_root);
-        get_merkle_root(current_block);
-        
-        if (strcmp(original_merkle_root, current_block->merkle_root) != 0) {
-            printf("Merkle root mismatch in block %d! Transactions have been tampered with.\n", i);
+        if (hash_block_header(current_block, calculated_hash) != BC_OK) {
+            log_message(BC_LOG_WARN, "Malformed hash field in block %d!", i);
             return 0;
         }
         
-        // Recalculer le hash du bloc
-        sprintf(buffer, "%d%ld%s%s", 
-                current_block->index, 
-                current_block->timestamp, 
-                current_block->previous_hash, 
-                current_block->merkle_root);
-        
-        sha256_hash(buffer, calculated_hash);
-        
         if (strcmp(calculated_hash, current_block->current_hash) != 0) {
-            printf("Hash mismatch in block %d! Block data has been tampered with.\n", i);
+            log_message(BC_LOG_WARN, "Hash mismatch in block %d! Block data has been tampered with.", i);
             return 0;
         }
     }
-    
-    printf("Blockchain integrity verified - all blocks are valid.\n");
     return 1;
 }
 
-void* replicate_block(void* arg) {
-    PeerNode* node = (PeerNode*)arg;
+int verify_blockchain_integrity(Blockchain* blockchain) {
+    METRIC_TIMER_START(timer);
+    
+    int valid = verify_chain(blockchain, 1);
+    if (valid) {
+        log_message(BC_LOG_INFO, "Blockchain integrity verified - all blocks are valid.");
+    }
     
-    printf("Peer %d is replicating the blockchain...\n", node->id);
+    METRIC_INC(METRIC_VERIFICATIONS);
+    if (!valid) {
+        METRIC_INC(METRIC_VERIFICATION_FAILURES);
+    }
+    METRIC_TIMER_STOP(timer, METRIC_HIST_VERIFICATION);
+    return valid;
+}
 
-    for (int i = 0; i < node->replica->length; i++) {
-        display_block(node->replica->blocks[i]);
+// Verify blocks [from, length) and their link to block from - 1, e.g. the
+// blocks a peer has just received on top of a chain it already trusts
+int verify_blockchain_from(Blockchain* blockchain, int from) {
+    if (from < 1) from = 1;
+    
+    int valid = verify_chain(blockchain, from);
+    if (!valid) {
+        METRIC_INC(METRIC_VERIFICATION_FAILURES);
     }
+    return valid;
+}
 
-    pthread_exit(NULL);
+// Drop the bodies of every block more than keep_depth blocks below the tip.
+// The balances they produced are folded into blockchain->snapshot first, so
+// the state at the pruning height stays available. Returns the number of
+// blocks whose body was dropped, or the status of create_snapshot()
+// (BC_ERR_PRUNED, BC_ERR_OVERFLOW, BC_ERR_NOMEM) if the state cannot be built.
+int prune_blockchain(Blockchain* blockchain, int keep_depth) {
+    if (keep_depth < 1) keep_depth = 1;  // The tip is still open for transactions
+    
+    int target_height = blockchain->length - keep_depth;
+    if (target_height <= blockchain->pruned_height) {
+        return 0;
+    }
+    
+    int status;
+    StateSnapshot* snapshot = create_snapshot(blockchain, target_height, &status);
+    if (snapshot == NULL) {
+        return status;
+    }
+    
+    int pruned = 0;
+    for (int i = blockchain->pruned_height; i < target_height; i++) {
+        if (!is_block_pruned(blockchain->blocks[i])) {
+            prune_block(blockchain->blocks[i]);
+            pruned++;
+        }
+    }
+    
+    free_snapshot(blockchain->snapshot);
+    blockchain->snapshot = snapshot;
+    blockchain->pruned_height = target_height;
+    
+    return pruned;
+}
+
+// Store the indices of the blocks where the account sends or receives, oldest
+// first, up to max_indices of them. Returns the total number of such blocks.
+int find_account_blocks(Blockchain* blockchain, const char* account, int* block_indices, int max_indices) {
+    int found = 0;
+    for (int i = 0; i < blockchain->length; i++) {
+        if (block_touches_account(blockchain->blocks[i], account)) {
+            if (found < max_indices) {
+                block_indices[found] = i;
+            }
+            found++;
+        }
+    }
+    return found;
 }
 
 int simulate_consensus(Block* block) {
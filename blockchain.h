@@ -2,11 +2,16 @@
 #define BLOCKCHAIN_H
 
 #include "block.h"
+#include "alloc.h"
+
+struct StateSnapshot;
 
 typedef struct {
     Block** blocks;
     int length;
     int capacity;
+    int pruned_height;               // Blocks below this height only keep their header
+    struct StateSnapshot* snapshot;  // Balances at pruned_height, NULL if nothing was pruned
 } Blockchain;
 
 typedef struct {
@@ -14,12 +19,17 @@ typedef struct {
     Blockchain* replica;
 } PeerNode;
 
-// Blockchain operations
+// Blockchain operations; pointers are NULL on allocation failure, int results
+// are a BlockchainStatus (logger.h) unless documented otherwise
 Blockchain* init_blockchain();
-void add_block(Blockchain* blockchain, Block* block);
+int add_block(Blockchain* blockchain, Block* block);
 Blockchain* deep_copy_blockchain(Blockchain* original);
+void retag_blockchain(Blockchain* blockchain, MemTag tag);
 void free_blockchain(Blockchain* blockchain);
-void calculate_blockchain_hash(Blockchain* blockchain, char* output);
-int verify_blockchain_integrity(Blockchain* blockchain);
+int calculate_blockchain_hash(Blockchain* blockchain, char* output);
+int verify_blockchain_integrity(Blockchain* blockchain);  // 1 if valid, 0 otherwise
+int verify_blockchain_from(Blockchain* blockchain, int from);  // Same, for blocks [from, length) only
+int prune_blockchain(Blockchain* blockchain, int keep_depth);
+int find_account_blocks(Blockchain* blockchain, const char* account, int* block_indices, int max_indices);
 
 #endif
@@ -0,0 +1,41 @@
+#include <string.h>
+#include "bloom.h"
+
+// 64-bit FNV-1a; the two halves seed the double hashing h1 + i * h2
+static uint64_t fnv1a(const char* key) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const unsigned char* p = (const unsigned char*)key; *p; p++) {
+        hash ^= *p;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void bloom_clear(BloomFilter* filter) {
+    memset(filter->bits, 0, sizeof(filter->bits));
+}
+
+void bloom_add(BloomFilter* filter, const char* key) {
+    uint64_t hash = fnv1a(key);
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        uint32_t bit = (h1 + i * h2) % BLOOM_BITS;
+        filter->bits[bit / 64] |= 1ULL << (bit % 64);
+    }
+}
+
+int bloom_might_contain(const BloomFilter* filter, const char* key) {
+    uint64_t hash = fnv1a(key);
+    uint32_t h1 = (uint32_t)hash;
+    uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+
+    for (int i = 0; i < BLOOM_HASHES; i++) {
+        uint32_t bit = (h1 + i * h2) % BLOOM_BITS;
+        if (!(filter->bits[bit / 64] & (1ULL << (bit % 64)))) {
+            return 0;
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,20 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+#include <stdint.h>
+
+// Bloom filter over the account names of one block. A block holds at most
+// 2 * MAX_TRANSACTIONS names; 512 bits and 4 probes keep the false positive
+// rate of a full block around 0.05%.
+#define BLOOM_BITS 512
+#define BLOOM_HASHES 4
+
+typedef struct {
+    uint64_t bits[BLOOM_BITS / 64];
+} BloomFilter;
+
+void bloom_clear(BloomFilter* filter);
+void bloom_add(BloomFilter* filter, const char* key);
+int bloom_might_contain(const BloomFilter* filter, const char* key);  // 0 means definitely absent
+
+#endif
@@ -0,0 +1,904 @@
+// cli.c - non-interactive batch commands for scripting and load tests
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cli.h"
+#include "ui.h"
+#include "blockchain.h"
+#include "block.h"
+#include "persist.h"
+#include "codec.h"
+#include "metrics.h"
+#include "logger.h"
+#include "signature.h"
+#include "thread_pool.h"
+#include "query.h"
+#include "columnar.h"
+#include "sealer.h"
+#include "alloc.h"
+#include "loadgen.h"
+#include "soak.h"
+#include "snapshot.h"
+#include "utils.h"
+
+// Worker pool for signature batches, created on first use
+static ThreadPool* pool = NULL;
+static int pool_threads = 0;
+static int body_codec = BODY_CODEC_PLAIN;
+
+static ThreadPool* get_pool() {
+    if (pool == NULL) {
+        pool = create_thread_pool(pool_threads);
+    }
+    return pool;
+}
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+void print_cli_usage(const char* program) {
+    printf("Usage: %s [--chain FILE] [--keys FILE] [--threads N] [--deflate] [--verbose] COMMAND [ARGS] [COMMAND [ARGS]...]\n", program);
+    printf("Without a command the interactive menu is started.\n\n");
+    printf("Commands run in order on the same chain:\n");
+    printf("  ingest FILE [--block-size N]  read one transaction per line, seal every N into a new block in the background\n");
+    printf("  verify [--require-signed]     verify hashes and signatures (exit status 2 if tampered)\n");
+    printf("  sign INPUT OUTPUT             sign every transaction with a test key derived from its sender,\n");
+    printf("                                register that key and number it with the sender's next nonce\n");
+    printf("  stats                         print chain statistics\n");
+    printf("  history ACCOUNT               list the blocks where ACCOUNT sends or receives\n");
+    printf("  query [OPTIONS]               scan transactions on all cores; options: --sender NAME\n");
+    printf("                                --receiver NAME --account NAME --min-amount N --max-amount N\n");
+    printf("                                --from-height N --to-height N --since UNIX --until UNIX --print\n");
+    printf("  prune DEPTH                   drop the bodies of blocks more than DEPTH below the tip\n");
+    printf("  export FILE                   write the chain to FILE\n");
+    printf("  columns FILE                  write the transactions to FILE in columnar layout\n");
+    printf("  analyze FILE [--window SECS]  sum amounts per account (and per window) from a columnar FILE\n");
+    printf("  import FILE                   replace the chain with the one stored in FILE\n");
+    printf("  metrics [FILE]                dump metrics in Prometheus text format\n");
+    printf("  mem                           live and peak bytes per allocation tag, bytes per block\n");
+    printf("  generate FILE COUNT [LOAD]    write COUNT generated transactions to FILE; LOAD options:\n");
+    printf("                                --seed N --accounts N --zipf S --median-amount A --sigma S\n");
+    printf("  soak [OPTIONS] [LOAD]         ingest, seal, replicate and verify generated load; options:\n");
+    printf("                                --seconds S --blocks N --block-size N --round N --replicas N --keep N\n\n");
+    printf("With --chain, the chain is loaded from FILE when it exists and saved back at the end.\n");
+    printf("With --keys, the account keys signatures are checked against are loaded and saved the same way.\n");
+    printf("With --deflate, block bodies written by export, --chain and soak replication are deflated.\n");
+}
+
+// Read one line into line[TX_STRING_SIZE], without its end of line. Returns
+// 1, 0 at the end of the file, or -1 for a line too long to hold a signed
+// transaction; the rest of that line is skipped rather than read as another.
+static int read_line(FILE* file, char line[TX_STRING_SIZE]) {
+    if (fgets(line, TX_STRING_SIZE, file) == NULL) {
+        return 0;
+    }
+
+    size_t length = strcspn(line, "\r\n");
+    if (line[length] == '\0' && length == TX_STRING_SIZE - 1) {
+        // Full buffer: the line fits only if its end comes next
+        int c = fgetc(file);
+        if (c == '\r') c = fgetc(file);
+        if (c == '\n' || c == EOF) return 1;
+        while ((c = fgetc(file)) != EOF && c != '\n') {}
+        return -1;
+    }
+    line[length] = '\0';
+    return 1;
+}
+
+// Drop the transactions from index `from` on that the key registry does not
+// authorize or that reuse a nonce of their sender; the nonces of the kept
+// ones are recorded in state. Returns how many were dropped, or BC_ERR_NOMEM.
+static int drop_invalid_transactions(Block* block, int from, const KeyRegistry* registry, StateSnapshot* state) {
+    const Transaction* txs[MAX_TRANSACTIONS];
+    int results[MAX_TRANSACTIONS];
+    int count = block->transaction_count - from;
+    int has_signed = 0;
+    for (int i = 0; i < count; i++) {
+        txs[i] = &block->transactions[from + i];
+        has_signed |= txs[i]->has_signature;
+    }
+
+    // Unsigned transactions only need a key lookup, not the pool
+    verify_signatures_batch(txs, count, 0, registry, results, has_signed ? get_pool() : NULL);
+
+    int kept = from;
+    for (int i = 0; i < count; i++) {
+        if (!results[i]) continue;
+        int status = advance_nonce(state, txs[i]);
+        if (status == BC_ERR_NOMEM) {
+            return status;
+        }
+        if (status == BC_OK) {
+            block->transactions[kept++] = *txs[i];
+        }
+    }
+    int dropped = block->transaction_count - kept;
+    block->transaction_count = kept;
+    return dropped;
+}
+
+// Blocks are filled here and sealed on the sealer thread, so parsing the
+// next block overlaps with hashing the previous one
+static int cmd_ingest(Blockchain* blockchain, const KeyRegistry* registry, const char* path, int block_size) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "ingest: cannot open %s\n", path);
+        return 1;
+    }
+
+    // Nonces already used on the chain, advanced as transactions are accepted
+    int status;
+    StateSnapshot* state = create_snapshot(blockchain, blockchain->length, &status);
+    if (state == NULL) {
+        fprintf(stderr, "ingest: %s\n", status_string(status));
+        fclose(file);
+        return 1;
+    }
+    Sealer* sealer = create_sealer(blockchain, 0);
+    if (sealer == NULL) {
+        fprintf(stderr, "ingest: %s\n", status_string(BC_ERR_NOMEM));
+        free_snapshot(state);
+        fclose(file);
+        return 1;
+    }
+
+    double start = now_ms();
+    long accepted = 0, rejected = 0;
+    Block* current = NULL;
+    int checked = 0;
+    char line[TX_STRING_SIZE];
+    int read;
+
+    while (status == BC_OK && (read = read_line(file, line)) != 0) {
+        if (read < 0) {
+            rejected++;
+            continue;
+        }
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        // Index and previous hash are filled in by the sealer
+        if (current == NULL) {
+            current = create_block(0, "");
+            if (current == NULL) {
+                status = BC_ERR_NOMEM;
+                break;
+            }
+            checked = 0;
+        }
+
+        if (append_transaction(current, line) != BC_OK) {
+            rejected++;
+            continue;
+        }
+        accepted++;
+
+        if (current->transaction_count >= block_size) {
+            int dropped = drop_invalid_transactions(current, checked, registry, state);
+            if (dropped < 0) {
+                status = dropped;
+                break;
+            }
+            accepted -= dropped;
+            rejected += dropped;
+            checked = current->transaction_count;
+            if (current->transaction_count < block_size) continue;
+
+            status = sealer_submit(sealer, current);
+            current = NULL;
+        }
+    }
+
+    if (status == BC_OK && current != NULL) {
+        int dropped = drop_invalid_transactions(current, checked, registry, state);
+        if (dropped < 0) {
+            status = dropped;
+        } else {
+            accepted -= dropped;
+            rejected += dropped;
+        }
+        if (status == BC_OK && current->transaction_count > 0) {
+            status = sealer_submit(sealer, current);
+            current = NULL;
+        }
+    }
+    free_block(current);
+    free_snapshot(state);
+    fclose(file);
+
+    int flushed = sealer_flush(sealer);
+    if (status == BC_OK) status = flushed;
+    SealerStats stats;
+    sealer_stats(sealer, &stats);
+    free_sealer(sealer);
+
+    double elapsed = now_ms() - start;
+    if (status != BC_OK) {
+        fprintf(stderr, "ingest: %s\n", status_string(status));
+        return 1;
+    }
+
+    printf("ingest: %ld transactions (%ld rejected) into %ld blocks in %.3f ms (%.0f tx/s, %ld sealer stalls)\n",
+           accepted, rejected, stats.sealed, elapsed, elapsed > 0 ? accepted * 1e3 / elapsed : 0.0, stats.stalls);
+    return 0;
+}
+
+static int cmd_verify(Blockchain* blockchain, const KeyRegistry* registry, int require_signed) {
+    double start = now_ms();
+    int valid = verify_blockchain_integrity(blockchain);
+    double hashes_done = now_ms();
+
+    int invalid_block = -1;
+    int status = BC_OK;
+    if (valid) {
+        status = verify_chain_signatures(blockchain, require_signed, registry, get_pool(), &invalid_block);
+        valid = status == BC_OK;
+    }
+    double elapsed = now_ms() - start;
+
+    if (status == BC_ERR_SIGNATURE) {
+        printf("verify: invalid signature in block %d\n", invalid_block);
+    } else if (status == BC_ERR_REPLAY) {
+        printf("verify: replayed nonce in block %d\n", invalid_block);
+    } else if (status != BC_OK) {
+        fprintf(stderr, "verify: %s\n", status_string(status));
+        return 1;
+    }
+    printf("verify: %s, %d blocks in %.3f ms (%.3f ms hashes, %.0f blocks/s)\n",
+           valid ? "valid" : "TAMPERED", blockchain->length, elapsed, hashes_done - start,
+           elapsed > 0 ? blockchain->length * 1e3 / elapsed : 0.0);
+    return valid ? 0 : 2;
+}
+
+// Test-data helper: the key of each sender is derived from SHA-256(sender),
+// so anyone can recompute it. Never use these keys for real funds. Each key is
+// registered for its sender, and transactions without a nonce get the next
+// one after the sender's last nonce on the chain.
+static int cmd_sign(Blockchain* blockchain, KeyRegistry* registry, const char* input_path, const char* output_path) {
+    int status;
+    StateSnapshot* state = create_snapshot(blockchain, blockchain->length, &status);
+    if (state == NULL) {
+        fprintf(stderr, "sign: %s\n", status_string(status));
+        return 1;
+    }
+    FILE* input = fopen(input_path, "r");
+    if (input == NULL) {
+        fprintf(stderr, "sign: cannot open %s\n", input_path);
+        free_snapshot(state);
+        return 1;
+    }
+    FILE* output = fopen(output_path, "w");
+    if (output == NULL) {
+        fprintf(stderr, "sign: cannot write %s\n", output_path);
+        fclose(input);
+        free_snapshot(state);
+        return 1;
+    }
+
+    double start = now_ms();
+    long signed_count = 0, skipped = 0;
+    char line[TX_STRING_SIZE];
+    int read;
+    while (status == BC_OK && (read = read_line(input, line)) != 0) {
+        Transaction tx;
+        if (read < 0 || !parse_transaction(line, &tx)) {
+            skipped++;
+            continue;
+        }
+
+        char seed_hex[65];
+        unsigned char seed[KEY_SEED_SIZE];
+        KeyPair keys;
+        sha256_hash(tx.sender, seed_hex);
+        hex_to_bytes(seed_hex, seed, KEY_SEED_SIZE);
+        if (keypair_from_seed(&keys, seed) != BC_OK) {
+            skipped++;
+            continue;
+        }
+
+        // A sender already bound to another key cannot be signed for here
+        if (tx.nonce == 0) {
+            tx.nonce = get_nonce(state, tx.sender) + 1;
+        }
+        int registered = register_account_key(registry, tx.sender, keys.public_key);
+        int signed_ok = registered == BC_OK && sign_transaction(&tx, &keys) == BC_OK
+                     && advance_nonce(state, &tx) == BC_OK;
+        free_keypair(&keys);
+        if (registered == BC_ERR_NOMEM) {
+            status = registered;
+            break;
+        }
+        if (!signed_ok) {
+            skipped++;
+            continue;
+        }
+
+        char encoded[TX_STRING_SIZE];
+        transaction_to_string(&tx, encoded, sizeof(encoded));
+        fprintf(output, "%s\n", encoded);
+        signed_count++;
+    }
+    fclose(input);
+    free_snapshot(state);
+    int failed = fclose(output) != 0;
+    double elapsed = now_ms() - start;
+
+    if (status != BC_OK) {
+        fprintf(stderr, "sign: %s\n", status_string(status));
+        return 1;
+    }
+    if (failed) {
+        fprintf(stderr, "sign: cannot write %s\n", output_path);
+        return 1;
+    }
+    printf("sign: %ld transactions signed (%ld skipped) in %.3f ms\n", signed_count, skipped, elapsed);
+    return 0;
+}
+
+static int cmd_stats(Blockchain* blockchain) {
+    double start = now_ms();
+    long transactions = 0;
+    amount_t total_value = 0;
+    int overflow = 0;
+
+    for (int i = 0; i < blockchain->length; i++) {
+        Block* block = blockchain->blocks[i];
+        transactions += block->transaction_count;
+        if (is_block_pruned(block)) continue;
+
+        amount_t block_total;
+        if (!overflow) {
+            overflow = sum_block_amounts(block, &block_total) != BC_OK
+                    || amount_add(total_value, block_total, &total_value) != BC_OK;
+        }
+    }
+
+    char chain_hash[65];
+    if (calculate_blockchain_hash(blockchain, chain_hash) != BC_OK) {
+        strcpy(chain_hash, "unavailable");
+    }
+    double elapsed = now_ms() - start;
+
+    char value[AMOUNT_STRING_SIZE];
+    printf("stats: blocks=%d transactions=%ld pruned_height=%d value_in_bodies=%s DA\n",
+           blockchain->length, transactions, blockchain->pruned_height,
+           overflow ? "overflow" : format_amount(total_value, value, sizeof(value)));
+    printf("stats: tip=%s\n", blockchain->blocks[blockchain->length - 1]->current_hash);
+    printf("stats: chain_hash=%s (%.3f ms)\n", chain_hash, elapsed);
+    return 0;
+}
+
+static int cmd_history(Blockchain* blockchain, const char* account) {
+    int indices[20];
+    int shown = sizeof(indices) / sizeof(indices[0]);
+
+    double start = now_ms();
+    int found = find_account_blocks(blockchain, account, indices, shown);
+    double elapsed = now_ms() - start;
+
+    printf("history: %s in %d of %d blocks (%.3f ms)\n", account, found, blockchain->length, elapsed);
+    if (found > 0) {
+        printf("history: blocks");
+        for (int i = 0; i < found && i < shown; i++) {
+            printf(" %d", indices[i]);
+        }
+        printf("%s\n", found > shown ? " ..." : "");
+    }
+    return 0;
+}
+
+typedef struct {
+    int print;
+    amount_t total_amount;
+    int overflow;
+} QueryReport;
+
+static int report_match(const Block* block, const Transaction* tx, void* user_data) {
+    QueryReport* report = (QueryReport*)user_data;
+    if (amount_add(report->total_amount, tx->amount, &report->total_amount) != BC_OK) {
+        report->overflow = 1;
+    }
+    if (report->print) {
+        char amount[AMOUNT_STRING_SIZE];
+        printf("query: block %d: %s sends %s DA to %s\n", block->index, tx->sender,
+               format_amount(tx->amount, amount, sizeof(amount)), tx->receiver);
+    }
+    return 0;
+}
+
+// Parse the query options following the command; returns the index of the
+// first argument that is not one of them, or -1 on a malformed option
+static int parse_query_options(int argc, char** argv, int i, TxQuery* query, int* print) {
+    init_tx_query(query);
+    *print = 0;
+
+    while (i < argc && strncmp(argv[i], "--", 2) == 0) {
+        const char* option = argv[i];
+        if (strcmp(option, "--print") == 0) {
+            *print = 1;
+            i++;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return -1;
+        }
+        const char* value = argv[i + 1];
+
+        if (strcmp(option, "--sender") == 0) query->sender = value;
+        else if (strcmp(option, "--receiver") == 0) query->receiver = value;
+        else if (strcmp(option, "--account") == 0) query->account = value;
+        else if (strcmp(option, "--min-amount") == 0) { if (!parse_amount(value, &query->min_amount)) return -1; }
+        else if (strcmp(option, "--max-amount") == 0) { if (!parse_amount(value, &query->max_amount)) return -1; }
+        else if (strcmp(option, "--from-height") == 0) query->min_height = atoi(value);
+        else if (strcmp(option, "--to-height") == 0) query->max_height = atoi(value);
+        else if (strcmp(option, "--since") == 0) query->min_time = atoll(value);
+        else if (strcmp(option, "--until") == 0) query->max_time = atoll(value);
+        else return -1;
+        i += 2;
+    }
+    return i;
+}
+
+static int cmd_query(Blockchain* blockchain, const TxQuery* query, int print) {
+    QueryReport report = {print, 0, 0};
+    TxQueryStats stats;
+
+    double start = now_ms();
+    int status = run_tx_query(blockchain, query, get_pool(), report_match, &report, &stats);
+    double elapsed = now_ms() - start;
+
+    if (status != BC_OK) {
+        fprintf(stderr, "query: %s\n", status_string(status));
+        return 1;
+    }
+    char total[AMOUNT_STRING_SIZE];
+    printf("query: %ld matches, %s DA total in %.3f ms (%d blocks scanned, %d skipped, %d pruned)\n",
+           stats.matches, report.overflow ? "overflow" : format_amount(report.total_amount, total, sizeof(total)), elapsed,
+           stats.blocks_scanned, stats.blocks_skipped, stats.blocks_pruned);
+    return 0;
+}
+
+static int cmd_prune(Blockchain* blockchain, int keep_depth) {
+    double start = now_ms();
+    int pruned = prune_blockchain(blockchain, keep_depth);
+    double elapsed = now_ms() - start;
+
+    if (pruned < 0) {
+        fprintf(stderr, "prune: %s\n", status_string(pruned));
+        return 1;
+    }
+    printf("prune: %d bodies dropped, pruned_height=%d in %.3f ms\n",
+           pruned, blockchain->pruned_height, elapsed);
+    return 0;
+}
+
+static int cmd_export(Blockchain* blockchain, const char* path) {
+    double start = now_ms();
+    int status = save_blockchain(blockchain, path, body_codec);
+    double elapsed = now_ms() - start;
+
+    if (status != BC_OK) {
+        fprintf(stderr, "export: %s: %s\n", path, status_string(status));
+        return 1;
+    }
+    printf("export: %d blocks to %s in %.3f ms\n", blockchain->length, path, elapsed);
+    return 0;
+}
+
+static int cmd_columns(Blockchain* blockchain, const char* path) {
+    double start = now_ms();
+    TxColumns* columns = build_tx_columns(blockchain);
+    if (columns == NULL) {
+        fprintf(stderr, "columns: %s\n", status_string(BC_ERR_NOMEM));
+        return 1;
+    }
+    int status = save_tx_columns(columns, path);
+    double elapsed = now_ms() - start;
+
+    if (status != BC_OK) {
+        fprintf(stderr, "columns: %s: %s\n", path, status_string(status));
+        free_tx_columns(columns);
+        return 1;
+    }
+    printf("columns: %ld rows, %u accounts to %s in %.3f ms\n", columns->rows, columns->name_count, path, elapsed);
+    free_tx_columns(columns);
+    return 0;
+}
+
+// Report over a columnar file: totals, the busiest senders and, with a
+// window, the volume per time window since the first transaction
+static int cmd_analyze(const char* path, int64_t window) {
+    double start = now_ms();
+    TxColumns* columns = NULL;
+    int status = load_tx_columns(path, &columns);
+    if (status != BC_OK) {
+        fprintf(stderr, "analyze: %s: %s\n", path, status_string(status));
+        return 1;
+    }
+    double loaded = now_ms();
+
+    amount_t* sent = (amount_t*)malloc((columns->name_count + 1) * sizeof(amount_t));
+    amount_t* received = (amount_t*)malloc((columns->name_count + 1) * sizeof(amount_t));
+    if (sent == NULL || received == NULL) {
+        fprintf(stderr, "analyze: %s\n", status_string(BC_ERR_NOMEM));
+        free(sent);
+        free(received);
+        free_tx_columns(columns);
+        return 1;
+    }
+
+    amount_t total;
+    status = sum_amounts(columns, INT64_MIN, INT64_MAX, &total);
+    if (status == BC_OK) {
+        status = sum_by_account(columns, sent, received);
+    }
+    double elapsed = now_ms() - loaded;
+    if (status != BC_OK) {
+        fprintf(stderr, "analyze: %s: %s\n", path, status_string(status));
+        free(sent);
+        free(received);
+        free_tx_columns(columns);
+        return 1;
+    }
+
+    char amount[AMOUNT_STRING_SIZE], other[AMOUNT_STRING_SIZE];
+    printf("analyze: %ld rows, %u accounts, %s DA total (load %.3f ms, aggregate %.3f ms)\n",
+           columns->rows, columns->name_count, format_amount(total, amount, sizeof(amount)), loaded - start, elapsed);
+
+    // Selection of the ten largest senders, enough for a console report
+    for (int rank = 0; rank < 10 && rank < (int)columns->name_count; rank++) {
+        uint32_t best = 0;
+        for (uint32_t id = 1; id < columns->name_count; id++) {
+            if (sent[id] > sent[best]) best = id;
+        }
+        if (sent[best] < 0) break;
+        printf("analyze: %-20s sent %s DA, received %s DA\n", columns->names[best],
+               format_amount(sent[best], amount, sizeof(amount)), format_amount(received[best], other, sizeof(other)));
+        sent[best] = -1;
+    }
+
+    if (window > 0 && columns->rows > 0) {
+        int64_t origin = columns->timestamps[0];
+        int64_t last = columns->timestamps[columns->rows - 1];
+        int window_count = (int)((last - origin) / window) + 1;
+        if (window_count > 100) window_count = 100;
+
+        amount_t* volumes = (amount_t*)malloc(window_count * sizeof(amount_t));
+        if (volumes != NULL) {
+            status = volume_by_window(columns, origin, window, volumes, window_count);
+            for (int w = 0; status == BC_OK && w < window_count; w++) {
+                printf("analyze: window %lld: %s DA\n", (long long)(origin + w * window),
+                       format_amount(volumes[w], amount, sizeof(amount)));
+            }
+            if (status != BC_OK) {
+                fprintf(stderr, "analyze: %s\n", status_string(status));
+            }
+            free(volumes);
+        }
+    }
+
+    free(sent);
+    free(received);
+    free_tx_columns(columns);
+    return 0;
+}
+
+static int cmd_import(Blockchain** blockchain, const char* path) {
+    double start = now_ms();
+    Blockchain* loaded = NULL;
+    int status = load_blockchain(path, &loaded);
+    double elapsed = now_ms() - start;
+
+    if (status != BC_OK) {
+        fprintf(stderr, "import: %s: %s\n", path, status_string(status));
+        return 1;
+    }
+    free_blockchain(*blockchain);
+    *blockchain = loaded;
+    printf("import: %d blocks from %s in %.3f ms\n", loaded->length, path, elapsed);
+    return 0;
+}
+
+static int cmd_metrics(const char* path) {
+    if (path == NULL) {
+        metrics_write(stdout);
+        return 0;
+    }
+    if (!metrics_dump_file(path)) {
+        fprintf(stderr, "metrics: cannot write %s\n", path);
+        return 1;
+    }
+    printf("metrics: written to %s\n", path);
+    return 0;
+}
+
+// Per-tag memory of the process so far, then the footprint of the chain
+static int cmd_mem(Blockchain* blockchain) {
+    print_mem_stats(stdout);
+
+    MemTagStats blocks, chain;
+    get_mem_stats(MEM_TAG_BLOCK, &blocks);
+    get_mem_stats(MEM_TAG_CHAIN, &chain);
+    printf("mem: %d blocks (%d pruned), %.0f bytes per block, %lld bytes of block pointers\n",
+           blockchain->length, blockchain->pruned_height,
+           (double)blocks.live_bytes / blockchain->length, chain.live_bytes);
+    return 0;
+}
+
+// 1 if option is a load generator option and its value was applied
+static int parse_load_option(const char* option, const char* value, LoadConfig* load) {
+    if (strcmp(option, "--seed") == 0) load->seed = strtoull(value, NULL, 10);
+    else if (strcmp(option, "--accounts") == 0) load->accounts = atoi(value);
+    else if (strcmp(option, "--zipf") == 0) load->zipf_exponent = atof(value);
+    else if (strcmp(option, "--median-amount") == 0) { if (!parse_amount(value, &load->median_amount)) return 0; }
+    else if (strcmp(option, "--sigma") == 0) load->amount_sigma = atof(value);
+    else return 0;
+    return 1;
+}
+
+// Same contract as parse_query_options()
+static int parse_soak_options(int argc, char** argv, int i, SoakConfig* config) {
+    while (i + 1 < argc && strncmp(argv[i], "--", 2) == 0) {
+        const char* option = argv[i];
+        const char* value = argv[i + 1];
+
+        if (strcmp(option, "--seconds") == 0) config->duration_seconds = atof(value);
+        else if (strcmp(option, "--blocks") == 0) config->max_blocks = atol(value);
+        else if (strcmp(option, "--block-size") == 0) config->block_size = atoi(value);
+        else if (strcmp(option, "--round") == 0) config->round_blocks = atoi(value);
+        else if (strcmp(option, "--replicas") == 0) config->replicas = atoi(value);
+        else if (strcmp(option, "--keep") == 0) config->keep_depth = atoi(value);
+        else if (!parse_load_option(option, value, &config->load)) return -1;
+        i += 2;
+    }
+    return i < argc && strncmp(argv[i], "--", 2) == 0 ? -1 : i;
+}
+
+static int cmd_generate(const char* path, long count, const LoadConfig* load) {
+    LoadGenerator* generator = create_load_generator(load);
+    if (generator == NULL) {
+        fprintf(stderr, "generate: %s\n", status_string(BC_ERR_INVALID_ARG));
+        return 1;
+    }
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "generate: cannot open %s\n", path);
+        free_load_generator(generator);
+        return 1;
+    }
+
+    double start = now_ms();
+    char line[256];
+    for (long i = 0; i < count && next_transaction(generator, line, sizeof(line)) == BC_OK; i++) {
+        fprintf(file, "%s\n", line);
+    }
+    int ok = fclose(file) == 0;
+    double elapsed = now_ms() - start;
+    free_load_generator(generator);
+
+    if (!ok) {
+        fprintf(stderr, "generate: %s: %s\n", path, status_string(BC_ERR_IO));
+        return 1;
+    }
+    printf("generate: %ld transactions over %d accounts to %s in %.3f ms\n", count, load->accounts, path, elapsed);
+    return 0;
+}
+
+static void print_latency(const char* stage, const LatencySummary* latency) {
+    printf("soak: %-10s %8ld %10.3f %10.3f %10.3f %10.3f\n", stage, latency->count,
+           latency->p50_ms, latency->p90_ms, latency->p99_ms, latency->max_ms);
+}
+
+// Exit status 2 when a replica diverged or failed verification
+static int cmd_soak(Blockchain* blockchain, const SoakConfig* config) {
+    SoakReport report;
+    int status = run_soak(blockchain, config, &report);
+    if (status != BC_OK && report.rounds == 0) {
+        fprintf(stderr, "soak: %s\n", status_string(status));
+        return 1;
+    }
+
+    printf("soak: %ld transactions (%ld rejected) in %ld blocks (%ld empty, not sealed), %ld rounds, %.3f s (%.0f tx/s)\n",
+           report.transactions, report.rejected, report.blocks, report.empty_blocks, report.rounds,
+           report.elapsed_ms / 1e3, report.tx_per_second);
+    printf("soak: %-10s %8s %10s %10s %10s %10s\n", "stage", "count", "p50 ms", "p90 ms", "p99 ms", "max ms");
+    print_latency("fill", &report.fill);
+    print_latency("submit", &report.submit);
+    print_latency("seal", &report.seal);
+    print_latency("replicate", &report.replicate);
+    print_latency("verify", &report.verify);
+    printf("soak: %d replicas, %ld divergences, %ld verification failures\n",
+           config->replicas, report.divergences, report.verification_failures);
+
+    if (status != BC_OK) {
+        fprintf(stderr, "soak: %s\n", status_string(status));
+        return 1;
+    }
+    return report.divergences > 0 || report.verification_failures > 0 ? 2 : 0;
+}
+
+static int cli_is_command(const char* word) {
+    static const char* commands[] = {"ingest", "verify", "sign", "stats", "history", "query", "columns", "analyze", "prune", "export", "import", "metrics", "mem", "generate", "soak"};
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (strcmp(word, commands[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+int run_cli(int argc, char** argv) {
+    const char* chain_path = NULL;
+    const char* keys_path = NULL;
+    int i = 1;
+
+    for (; i < argc && strncmp(argv[i], "--", 2) == 0; i++) {
+        if (strcmp(argv[i], "--chain") == 0 && i + 1 < argc) {
+            chain_path = argv[++i];
+        } else if (strcmp(argv[i], "--keys") == 0 && i + 1 < argc) {
+            keys_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            pool_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--deflate") == 0) {
+            body_codec = BODY_CODEC_DEFLATE;
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            set_log_callback(console_log, BC_LOG_INFO, NULL);
+        } else {
+            print_cli_usage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    KeyRegistry* registry = NULL;
+    int status = keys_path != NULL ? load_key_registry(keys_path, &registry) : BC_ERR_IO;
+    if (status == BC_ERR_IO) {
+        registry = create_key_registry();
+        status = registry != NULL ? BC_OK : BC_ERR_NOMEM;
+    }
+    if (status != BC_OK) {
+        fprintf(stderr, "%s: %s\n", keys_path != NULL ? keys_path : "keys", status_string(status));
+        return 1;
+    }
+
+    Blockchain* blockchain = NULL;
+    FILE* existing = chain_path != NULL ? fopen(chain_path, "rb") : NULL;
+    if (existing != NULL) {
+        fclose(existing);
+        status = load_blockchain(chain_path, &blockchain);
+        if (status != BC_OK) {
+            fprintf(stderr, "%s: %s\n", chain_path, status_string(status));
+            free_key_registry(registry);
+            return 1;
+        }
+    } else {
+        blockchain = init_blockchain();
+        if (blockchain == NULL) {
+            fprintf(stderr, "%s\n", status_string(BC_ERR_NOMEM));
+            free_key_registry(registry);
+            return 1;
+        }
+    }
+
+    int result = 0;
+    while (result == 0 && i < argc) {
+        const char* command = argv[i++];
+
+        if (strcmp(command, "ingest") == 0 && i < argc) {
+            const char* path = argv[i++];
+            int block_size = MAX_TRANSACTIONS;
+            if (i + 1 < argc && strcmp(argv[i], "--block-size") == 0) {
+                block_size = atoi(argv[i + 1]);
+                i += 2;
+            }
+            if (block_size < 1 || block_size > MAX_TRANSACTIONS) {
+                fprintf(stderr, "ingest: block size must be between 1 and %d\n", MAX_TRANSACTIONS);
+                result = 1;
+            } else {
+                result = cmd_ingest(blockchain, registry, path, block_size);
+            }
+        } else if (strcmp(command, "verify") == 0) {
+            int require_signed = 0;
+            if (i < argc && strcmp(argv[i], "--require-signed") == 0) {
+                require_signed = 1;
+                i++;
+            }
+            result = cmd_verify(blockchain, registry, require_signed);
+        } else if (strcmp(command, "sign") == 0 && i + 1 < argc) {
+            result = cmd_sign(blockchain, registry, argv[i], argv[i + 1]);
+            i += 2;
+        } else if (strcmp(command, "stats") == 0) {
+            result = cmd_stats(blockchain);
+        } else if (strcmp(command, "history") == 0 && i < argc) {
+            result = cmd_history(blockchain, argv[i++]);
+        } else if (strcmp(command, "query") == 0) {
+            TxQuery query;
+            int print;
+            int next = parse_query_options(argc, argv, i, &query, &print);
+            if (next < 0) {
+                fprintf(stderr, "query: invalid option\n");
+                result = 1;
+            } else {
+                i = next;
+                result = cmd_query(blockchain, &query, print);
+            }
+        } else if (strcmp(command, "prune") == 0 && i < argc) {
+            result = cmd_prune(blockchain, atoi(argv[i++]));
+        } else if (strcmp(command, "export") == 0 && i < argc) {
+            result = cmd_export(blockchain, argv[i++]);
+        } else if (strcmp(command, "columns") == 0 && i < argc) {
+            result = cmd_columns(blockchain, argv[i++]);
+        } else if (strcmp(command, "analyze") == 0 && i < argc) {
+            const char* path = argv[i++];
+            int64_t window = 0;
+            if (i + 1 < argc && strcmp(argv[i], "--window") == 0) {
+                window = atoll(argv[i + 1]);
+                i += 2;
+            }
+            result = cmd_analyze(path, window);
+        } else if (strcmp(command, "import") == 0 && i < argc) {
+            result = cmd_import(&blockchain, argv[i++]);
+        } else if (strcmp(command, "metrics") == 0) {
+            const char* path = NULL;
+            if (i < argc && !cli_is_command(argv[i])) {
+                path = argv[i++];
+            }
+            result = cmd_metrics(path);
+        } else if (strcmp(command, "mem") == 0) {
+            result = cmd_mem(blockchain);
+        } else if (strcmp(command, "generate") == 0 && i + 1 < argc) {
+            const char* path = argv[i];
+            long count = atol(argv[i + 1]);
+            LoadConfig load;
+            init_load_config(&load);
+            i += 2;
+            while (i + 1 < argc && parse_load_option(argv[i], argv[i + 1], &load)) {
+                i += 2;
+            }
+            if (i < argc && strncmp(argv[i], "--", 2) == 0) {
+                fprintf(stderr, "generate: invalid option %s\n", argv[i]);
+                result = 1;
+            } else {
+                result = cmd_generate(path, count, &load);
+            }
+        } else if (strcmp(command, "soak") == 0) {
+            SoakConfig config;
+            init_soak_config(&config);
+            config.body_codec = body_codec;
+            int next = parse_soak_options(argc, argv, i, &config);
+            if (next < 0) {
+                fprintf(stderr, "soak: invalid option\n");
+                result = 1;
+            } else {
+                i = next;
+                result = cmd_soak(blockchain, &config);
+            }
+        } else {
+            fprintf(stderr, "Unknown command or missing argument: %s\n", command);
+            print_cli_usage(argv[0]);
+            result = 1;
+        }
+    }
+
+    if (result != 1 && chain_path != NULL) {
+        status = save_blockchain(blockchain, chain_path, body_codec);
+        if (status != BC_OK) {
+            fprintf(stderr, "%s: %s\n", chain_path, status_string(status));
+            result = 1;
+        }
+    }
+    if (result != 1 && keys_path != NULL) {
+        status = save_key_registry(registry, keys_path);
+        if (status != BC_OK) {
+            fprintf(stderr, "%s: %s\n", keys_path, status_string(status));
+            result = 1;
+        }
+    }
+
+    free_key_registry(registry);
+    free_blockchain(blockchain);
+    free_thread_pool(pool);
+    pool = NULL;
+    return result;
+}
@@ -0,0 +1,8 @@
+// cli.h
+#ifndef CLI_H
+#define CLI_H
+
+int run_cli(int argc, char** argv);
+void print_cli_usage(const char* program);
+
+#endif
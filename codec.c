@@ -0,0 +1,209 @@
+#include <string.h>
+#include <stdint.h>
+#include <zlib.h>
+#include "codec.h"
+#include "logger.h"
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+} Writer;
+
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+} Reader;
+
+static int put_bytes(Writer* writer, const void* bytes, size_t count) {
+    if (writer->capacity - writer->size < count) {
+        return 0;
+    }
+    memcpy(writer->data + writer->size, bytes, count);
+    writer->size += count;
+    return 1;
+}
+
+static int put_varint(Writer* writer, uint64_t value) {
+    unsigned char bytes[10];
+    int count = 0;
+    do {
+        bytes[count] = (unsigned char)(value & 0x7f);
+        value >>= 7;
+        if (value != 0) bytes[count] |= 0x80;
+        count++;
+    } while (value != 0);
+    return put_bytes(writer, bytes, count);
+}
+
+static int get_bytes(Reader* reader, void* bytes, size_t count) {
+    if (reader->size - reader->offset < count) {
+        return 0;
+    }
+    memcpy(bytes, reader->data + reader->offset, count);
+    reader->offset += count;
+    return 1;
+}
+
+static int get_varint(Reader* reader, uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (reader->offset >= reader->size) {
+            return 0;
+        }
+        unsigned char byte = reader->data[reader->offset++];
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Amounts are signed in memory; zigzag keeps small magnitudes short
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// Index of name in the dictionary, appending it if new
+static int dictionary_id(const char* names[], int* count, const char* name) {
+    for (int i = 0; i < *count; i++) {
+        if (strcmp(names[i], name) == 0) return i;
+    }
+    names[*count] = name;
+    return (*count)++;
+}
+
+static int encode_plain(const Block* block, Writer* writer) {
+    const char* names[2 * MAX_TRANSACTIONS];
+    int name_count = 0;
+    int senders[MAX_TRANSACTIONS], receivers[MAX_TRANSACTIONS];
+
+    for (int i = 0; i < block->transaction_count; i++) {
+        senders[i] = dictionary_id(names, &name_count, block->transactions[i].sender);
+        receivers[i] = dictionary_id(names, &name_count, block->transactions[i].receiver);
+    }
+
+    int ok = put_varint(writer, block->transaction_count) && put_varint(writer, name_count);
+    for (int i = 0; ok && i < name_count; i++) {
+        size_t length = strlen(names[i]);
+        ok = put_varint(writer, length) && put_bytes(writer, names[i], length);
+    }
+
+    // The signature flag rides in the low bit of the sender id
+    for (int i = 0; ok && i < block->transaction_count; i++) {
+        const Transaction* tx = &block->transactions[i];
+        int is_signed = tx->has_signature != 0;
+        ok = put_varint(writer, ((uint64_t)senders[i] << 1) | is_signed)
+          && put_varint(writer, receivers[i])
+          && put_varint(writer, zigzag(tx->amount))
+          && put_varint(writer, tx->nonce)
+          && (!is_signed || (put_bytes(writer, tx->public_key, PUBLIC_KEY_SIZE)
+                             && put_bytes(writer, tx->signature, SIGNATURE_SIZE)));
+    }
+    return ok;
+}
+
+// Encode the body of a block that has not been pruned. Returns BC_OK, or
+// BC_ERR_INVALID_ARG when the output buffer is too small.
+int encode_block_body(const Block* block, int flags, unsigned char* output, size_t capacity, size_t* size) {
+    unsigned char plain[BODY_MAX_ENCODED_SIZE];
+    Writer writer = {plain, 0, sizeof(plain)};
+    if (!encode_plain(block, &writer)) {
+        return BC_ERR_INVALID_ARG;
+    }
+
+    if (flags & BODY_CODEC_DEFLATE) {
+        uLongf packed_size = capacity > 1 ? capacity - 1 : 0;
+        if (capacity > 1
+            && compress2(output + 1, &packed_size, plain, writer.size, Z_BEST_SPEED) == Z_OK
+            && packed_size < writer.size) {
+            output[0] = BODY_CODEC_DEFLATE | BODY_HAS_NONCES;
+            *size = packed_size + 1;
+            return BC_OK;
+        }
+    }
+
+    if (capacity < writer.size + 1) {
+        return BC_ERR_INVALID_ARG;
+    }
+    output[0] = BODY_CODEC_PLAIN | BODY_HAS_NONCES;
+    memcpy(output + 1, plain, writer.size);
+    *size = writer.size + 1;
+    return BC_OK;
+}
+
+static int decode_plain(Reader* reader, int has_nonces, Block* block) {
+    uint64_t tx_count, name_count;
+    if (!get_varint(reader, &tx_count) || tx_count > MAX_TRANSACTIONS
+        || !get_varint(reader, &name_count) || name_count > 2 * MAX_TRANSACTIONS) {
+        return BC_ERR_FORMAT;
+    }
+
+    char names[2 * MAX_TRANSACTIONS][64];
+    for (uint64_t i = 0; i < name_count; i++) {
+        uint64_t length;
+        if (!get_varint(reader, &length) || length >= sizeof(names[i])
+            || !get_bytes(reader, names[i], length)) {
+            return BC_ERR_FORMAT;
+        }
+        names[i][length] = '\0';
+    }
+
+    for (uint64_t i = 0; i < tx_count; i++) {
+        Transaction* tx = &block->transactions[i];
+        uint64_t sender, receiver, amount, nonce = 0;
+        if (!get_varint(reader, &sender) || (sender >> 1) >= name_count
+            || !get_varint(reader, &receiver) || receiver >= name_count
+            || !get_varint(reader, &amount)
+            || (has_nonces && !get_varint(reader, &nonce))) {
+            return BC_ERR_FORMAT;
+        }
+
+        strcpy(tx->sender, names[sender >> 1]);
+        strcpy(tx->receiver, names[receiver]);
+        tx->amount = unzigzag(amount);
+        tx->nonce = nonce;
+        tx->has_signature = (int)(sender & 1);
+        if (tx->has_signature
+            && (!get_bytes(reader, tx->public_key, PUBLIC_KEY_SIZE)
+                || !get_bytes(reader, tx->signature, SIGNATURE_SIZE))) {
+            return BC_ERR_FORMAT;
+        }
+    }
+
+    if (reader->offset != reader->size) {
+        return BC_ERR_FORMAT;
+    }
+    block->transaction_count = (int)tx_count;
+    return BC_OK;
+}
+
+// Fill the transactions of a block that has a body from an encoded body
+int decode_block_body(const unsigned char* data, size_t size, Block* block) {
+    if (size < 1) {
+        return BC_ERR_FORMAT;
+    }
+
+    int has_nonces = (data[0] & BODY_HAS_NONCES) != 0;
+    int form = data[0] & ~BODY_HAS_NONCES;
+    if (form == BODY_CODEC_PLAIN) {
+        Reader reader = {data + 1, size - 1, 0};
+        return decode_plain(&reader, has_nonces, block);
+    }
+    if (form == BODY_CODEC_DEFLATE) {
+        unsigned char plain[BODY_MAX_ENCODED_SIZE];
+        uLongf plain_size = sizeof(plain);
+        if (uncompress(plain, &plain_size, data + 1, size - 1) != Z_OK) {
+            return BC_ERR_FORMAT;
+        }
+        Reader reader = {plain, plain_size, 0};
+        return decode_plain(&reader, has_nonces, block);
+    }
+    return BC_ERR_FORMAT;
+}
@@ -0,0 +1,24 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stddef.h>
+#include "block.h"
+
+// Compact block body encoding used by persistence and node sync. The account
+// names of the body go into a per-block dictionary and every integer is a
+// LEB128 varint; with BODY_CODEC_DEFLATE the result is deflated on top when
+// that makes it smaller. The first byte tells which form was written, with
+// BODY_HAS_NONCES set when every transaction carries a nonce varint (bodies
+// encoded before nonces existed decode with nonce 0).
+#define BODY_CODEC_PLAIN 0
+#define BODY_CODEC_DEFLATE 1
+#define BODY_HAS_NONCES 2
+
+// Bound on any encoded body: MAX_TRANSACTIONS with two distinct 63-byte names
+// and a signature each, plus varints (nonces included) and deflate overhead
+#define BODY_MAX_ENCODED_SIZE 4096
+
+int encode_block_body(const Block* block, int flags, unsigned char* output, size_t capacity, size_t* size);
+int decode_block_body(const unsigned char* data, size_t size, Block* block);
+
+#endif
@@ -0,0 +1,332 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "columnar.h"
+#include "logger.h"
+
+static uint32_t hash_name(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        hash ^= *p;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static TxColumns* alloc_tx_columns(long rows) {
+    TxColumns* columns = (TxColumns*)calloc(1, sizeof(TxColumns));
+    if (columns == NULL) {
+        return NULL;
+    }
+
+    size_t n = rows > 0 ? (size_t)rows : 1;
+    columns->rows = rows;
+    columns->heights = (int32_t*)malloc(n * sizeof(int32_t));
+    columns->timestamps = (int64_t*)malloc(n * sizeof(int64_t));
+    columns->senders = (uint32_t*)malloc(n * sizeof(uint32_t));
+    columns->receivers = (uint32_t*)malloc(n * sizeof(uint32_t));
+    columns->amounts = (amount_t*)malloc(n * sizeof(amount_t));
+    columns->name_capacity = 64;
+    columns->names = (char**)malloc(columns->name_capacity * sizeof(char*));
+    columns->slot_count = 128;
+    columns->slots = (uint32_t*)calloc(columns->slot_count, sizeof(uint32_t));
+
+    if (columns->heights == NULL || columns->timestamps == NULL || columns->senders == NULL
+        || columns->receivers == NULL || columns->amounts == NULL
+        || columns->names == NULL || columns->slots == NULL) {
+        free_tx_columns(columns);
+        return NULL;
+    }
+    return columns;
+}
+
+void free_tx_columns(TxColumns* columns) {
+    if (columns == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i < columns->name_count; i++) {
+        free(columns->names[i]);
+    }
+    free(columns->names);
+    free(columns->slots);
+    free(columns->heights);
+    free(columns->timestamps);
+    free(columns->senders);
+    free(columns->receivers);
+    free(columns->amounts);
+    free(columns);
+}
+
+int64_t find_account_id(const TxColumns* columns, const char* name) {
+    uint32_t mask = columns->slot_count - 1;
+    for (uint32_t slot = hash_name(name) & mask; columns->slots[slot] != 0; slot = (slot + 1) & mask) {
+        uint32_t id = columns->slots[slot] - 1;
+        if (strcmp(columns->names[id], name) == 0) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+// Double the index and rehash every name; keeps the load factor below 1/2
+static int grow_slots(TxColumns* columns) {
+    uint32_t slot_count = columns->slot_count * 2;
+    uint32_t* slots = (uint32_t*)calloc(slot_count, sizeof(uint32_t));
+    if (slots == NULL) {
+        return BC_ERR_NOMEM;
+    }
+
+    for (uint32_t id = 0; id < columns->name_count; id++) {
+        uint32_t slot = hash_name(columns->names[id]) & (slot_count - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (slot_count - 1);
+        slots[slot] = id + 1;
+    }
+    free(columns->slots);
+    columns->slots = slots;
+    columns->slot_count = slot_count;
+    return BC_OK;
+}
+
+// Return the id of name, adding it to the dictionary if needed; -1 on allocation failure
+static int64_t intern_name(TxColumns* columns, const char* name) {
+    int64_t existing = find_account_id(columns, name);
+    if (existing >= 0) {
+        return existing;
+    }
+
+    if ((columns->name_count + 1) * 2 > columns->slot_count && grow_slots(columns) != BC_OK) {
+        return -1;
+    }
+    if (columns->name_count == columns->name_capacity) {
+        char** names = (char**)realloc(columns->names, columns->name_capacity * 2 * sizeof(char*));
+        if (names == NULL) {
+            return -1;
+        }
+        columns->names = names;
+        columns->name_capacity *= 2;
+    }
+
+    char* copy = strdup(name);
+    if (copy == NULL) {
+        return -1;
+    }
+    uint32_t id = columns->name_count++;
+    columns->names[id] = copy;
+
+    uint32_t mask = columns->slot_count - 1;
+    uint32_t slot = hash_name(name) & mask;
+    while (columns->slots[slot] != 0) slot = (slot + 1) & mask;
+    columns->slots[slot] = id + 1;
+    return id;
+}
+
+TxColumns* build_tx_columns(Blockchain* blockchain) {
+    long rows = 0;
+    for (int i = 0; i < blockchain->length; i++) {
+        if (!is_block_pruned(blockchain->blocks[i])) {
+            rows += blockchain->blocks[i]->transaction_count;
+        }
+    }
+
+    TxColumns* columns = alloc_tx_columns(rows);
+    if (columns == NULL) {
+        return NULL;
+    }
+
+    long row = 0;
+    for (int i = 0; i < blockchain->length; i++) {
+        Block* block = blockchain->blocks[i];
+        if (is_block_pruned(block)) continue;
+
+        for (int j = 0; j < block->transaction_count; j++) {
+            Transaction* tx = &block->transactions[j];
+            int64_t sender = intern_name(columns, tx->sender);
+            int64_t receiver = intern_name(columns, tx->receiver);
+            if (sender < 0 || receiver < 0) {
+                free_tx_columns(columns);
+                return NULL;
+            }
+
+            columns->heights[row] = block->index;
+            columns->timestamps[row] = (int64_t)block->timestamp;
+            columns->senders[row] = (uint32_t)sender;
+            columns->receivers[row] = (uint32_t)receiver;
+            columns->amounts[row] = tx->amount;
+            row++;
+        }
+    }
+    return columns;
+}
+
+static int write_bytes(FILE* file, const void* data, size_t size) {
+    return fwrite(data, 1, size, file) == size;
+}
+
+static int read_bytes(FILE* file, void* data, size_t size) {
+    return fread(data, 1, size, file) == size;
+}
+
+// Layout: magic, version, row count, dictionary (name count, then length-
+// prefixed names), then each column as one contiguous array in host byte order
+int save_tx_columns(const TxColumns* columns, const char* path) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return BC_ERR_IO;
+    }
+
+    uint32_t version = COLUMN_FILE_VERSION;
+    int64_t rows = columns->rows;
+    size_t n = (size_t)columns->rows;
+    int ok = write_bytes(file, COLUMN_FILE_MAGIC, 4)
+          && write_bytes(file, &version, sizeof(version))
+          && write_bytes(file, &rows, sizeof(rows))
+          && write_bytes(file, &columns->name_count, sizeof(columns->name_count));
+
+    for (uint32_t i = 0; ok && i < columns->name_count; i++) {
+        uint16_t length = (uint16_t)strlen(columns->names[i]);
+        ok = write_bytes(file, &length, sizeof(length)) && write_bytes(file, columns->names[i], length);
+    }
+
+    ok = ok && write_bytes(file, columns->heights, n * sizeof(int32_t))
+            && write_bytes(file, columns->timestamps, n * sizeof(int64_t))
+            && write_bytes(file, columns->senders, n * sizeof(uint32_t))
+            && write_bytes(file, columns->receivers, n * sizeof(uint32_t))
+            && write_bytes(file, columns->amounts, n * sizeof(amount_t));
+
+    if (fclose(file) != 0) ok = 0;
+    return ok ? BC_OK : BC_ERR_IO;
+}
+
+static int read_names(FILE* file, TxColumns* columns, uint32_t name_count) {
+    char name[65536];
+    for (uint32_t i = 0; i < name_count; i++) {
+        uint16_t length;
+        if (!read_bytes(file, &length, sizeof(length)) || !read_bytes(file, name, length)) {
+            return BC_ERR_FORMAT;
+        }
+        name[length] = '\0';
+        if (find_account_id(columns, name) >= 0) {
+            return BC_ERR_FORMAT;
+        }
+        if (intern_name(columns, name) < 0) {
+            return BC_ERR_NOMEM;
+        }
+    }
+    return BC_OK;
+}
+
+int load_tx_columns(const char* path, TxColumns** out) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return BC_ERR_IO;
+    }
+
+    char magic[4];
+    uint32_t version, name_count;
+    int64_t rows;
+    if (!read_bytes(file, magic, 4) || memcmp(magic, COLUMN_FILE_MAGIC, 4) != 0
+        || !read_bytes(file, &version, sizeof(version)) || version != COLUMN_FILE_VERSION
+        || !read_bytes(file, &rows, sizeof(rows))
+        || !read_bytes(file, &name_count, sizeof(name_count))
+        || rows < 0 || rows > (int64_t)1 << 40) {
+        fclose(file);
+        return BC_ERR_FORMAT;
+    }
+
+    TxColumns* columns = alloc_tx_columns((long)rows);
+    if (columns == NULL) {
+        fclose(file);
+        return BC_ERR_NOMEM;
+    }
+
+    size_t n = (size_t)rows;
+    int status = read_names(file, columns, name_count);
+    if (status == BC_OK
+        && (!read_bytes(file, columns->heights, n * sizeof(int32_t))
+            || !read_bytes(file, columns->timestamps, n * sizeof(int64_t))
+            || !read_bytes(file, columns->senders, n * sizeof(uint32_t))
+            || !read_bytes(file, columns->receivers, n * sizeof(uint32_t))
+            || !read_bytes(file, columns->amounts, n * sizeof(amount_t)))) {
+        status = BC_ERR_FORMAT;
+    }
+    fclose(file);
+
+    for (size_t i = 0; status == BC_OK && i < n; i++) {
+        if (columns->senders[i] >= name_count || columns->receivers[i] >= name_count) {
+            status = BC_ERR_FORMAT;
+        }
+    }
+    if (status != BC_OK) {
+        free_tx_columns(columns);
+        return status;
+    }
+
+    *out = columns;
+    return BC_OK;
+}
+
+// Total amount of the rows whose timestamp lies in [min_time, max_time], or
+// BC_ERR_OVERFLOW. Time-bounded sums mask the amounts a chunk at a time (a
+// branch-free loop that vectorizes with 64-bit vector compares, e.g. -mavx2)
+// and hand each chunk to the overflow-checked kernel.
+int sum_amounts(const TxColumns* columns, int64_t min_time, int64_t max_time, amount_t* total) {
+    if (min_time == INT64_MIN && max_time == INT64_MAX) {
+        return sum_amounts_checked(columns->amounts, columns->rows, total);
+    }
+
+    const int64_t* restrict timestamps = columns->timestamps;
+    const amount_t* restrict amounts = columns->amounts;
+    amount_t masked[1024];
+    amount_t sum = 0;
+
+    for (long start = 0; start < columns->rows; start += 1024) {
+        long count = columns->rows - start < 1024 ? columns->rows - start : 1024;
+        for (long i = 0; i < count; i++) {
+            int64_t in_range = (timestamps[start + i] >= min_time) & (timestamps[start + i] <= max_time);
+            masked[i] = amounts[start + i] & -in_range;
+        }
+
+        amount_t chunk;
+        if (sum_amounts_checked(masked, count, &chunk) != BC_OK || amount_add(sum, chunk, &sum) != BC_OK) {
+            return BC_ERR_OVERFLOW;
+        }
+    }
+    *total = sum;
+    return BC_OK;
+}
+
+// Group-by account: the dictionary ids are dense, so each group is a slot
+int sum_by_account(const TxColumns* columns, amount_t* sent, amount_t* received) {
+    const uint32_t* restrict senders = columns->senders;
+    const uint32_t* restrict receivers = columns->receivers;
+    const amount_t* restrict amounts = columns->amounts;
+
+    memset(sent, 0, columns->name_count * sizeof(amount_t));
+    memset(received, 0, columns->name_count * sizeof(amount_t));
+    for (long i = 0; i < columns->rows; i++) {
+        if (amount_add(sent[senders[i]], amounts[i], &sent[senders[i]]) != BC_OK
+            || amount_add(received[receivers[i]], amounts[i], &received[receivers[i]]) != BC_OK) {
+            return BC_ERR_OVERFLOW;
+        }
+    }
+    return BC_OK;
+}
+
+// volumes[w] is the total amount of the rows with origin + w * window <= timestamp
+// < origin + (w + 1) * window; rows outside the windows are ignored
+int volume_by_window(const TxColumns* columns, int64_t origin, int64_t window, amount_t* volumes, int window_count) {
+    memset(volumes, 0, window_count * sizeof(amount_t));
+    if (window <= 0) {
+        return BC_ERR_INVALID_ARG;
+    }
+
+    for (long i = 0; i < columns->rows; i++) {
+        int64_t offset = columns->timestamps[i] - origin;
+        if (offset < 0) continue;
+        int64_t w = offset / window;
+        if (w < window_count && amount_add(volumes[w], columns->amounts[i], &volumes[w]) != BC_OK) {
+            return BC_ERR_OVERFLOW;
+        }
+    }
+    return BC_OK;
+}
@@ -0,0 +1,44 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include <stdint.h>
+#include "blockchain.h"
+#include "amount.h"
+
+// Transactions of a chain laid out column by column for analytics. Account
+// names are interned in a dictionary and the sender/receiver columns hold
+// dictionary ids. Pruned blocks have no body and contribute no rows.
+#define COLUMN_FILE_MAGIC "SBCC"
+#define COLUMN_FILE_VERSION 2   // 2: fixed-point amounts
+
+typedef struct {
+    long rows;
+    int32_t* heights;
+    int64_t* timestamps;
+    uint32_t* senders;
+    uint32_t* receivers;
+    amount_t* amounts;
+
+    // String dictionary: names[id], with an open-addressing index for interning
+    char** names;
+    uint32_t name_count;
+    uint32_t name_capacity;
+    uint32_t* slots;         // id + 1 per slot, 0 when empty
+    uint32_t slot_count;     // Power of two
+} TxColumns;
+
+// Pointers are NULL on allocation failure, int results are a BlockchainStatus
+TxColumns* build_tx_columns(Blockchain* blockchain);
+void free_tx_columns(TxColumns* columns);
+int save_tx_columns(const TxColumns* columns, const char* path);
+int load_tx_columns(const char* path, TxColumns** out);
+int64_t find_account_id(const TxColumns* columns, const char* name);  // -1 if unknown
+
+// Aggregate kernels over the columns; output arrays are zeroed first and the
+// result is BC_OK or BC_ERR_OVERFLOW, or BC_ERR_INVALID_ARG from
+// volume_by_window() when window is not positive
+int sum_amounts(const TxColumns* columns, int64_t min_time, int64_t max_time, amount_t* total);
+int sum_by_account(const TxColumns* columns, amount_t* sent, amount_t* received);  // name_count entries each
+int volume_by_window(const TxColumns* columns, int64_t origin, int64_t window, amount_t* volumes, int window_count);
+
+#endif
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "loadgen.h"
+#include "logger.h"
+
+struct LoadGenerator {
+    LoadConfig config;
+    uint64_t state[4];     // xoshiro256**
+    double* sender_cdf;    // Cumulative Zipf weights, normalized to 1
+};
+
+static uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t next_random(LoadGenerator* generator) {
+    uint64_t* s = generator->state;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Uniform in [0, 1)
+static double next_uniform(LoadGenerator* generator) {
+    return (next_random(generator) >> 11) * 0x1.0p-53;
+}
+
+static uint64_t splitmix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+void init_load_config(LoadConfig* config) {
+    config->seed = 1;
+    config->accounts = 1000;
+    config->zipf_exponent = 1.0;
+    config->median_amount = DA(50);
+    config->amount_sigma = 1.0;
+}
+
+LoadGenerator* create_load_generator(const LoadConfig* config) {
+    if (config->accounts < 2 || config->zipf_exponent < 0
+        || config->median_amount <= 0 || config->amount_sigma < 0) {
+        return NULL;
+    }
+
+    LoadGenerator* generator = (LoadGenerator*)malloc(sizeof(LoadGenerator));
+    if (generator == NULL) {
+        return NULL;
+    }
+    generator->sender_cdf = (double*)malloc(config->accounts * sizeof(double));
+    if (generator->sender_cdf == NULL) {
+        free(generator);
+        return NULL;
+    }
+    generator->config = *config;
+
+    uint64_t seed = config->seed;
+    for (int i = 0; i < 4; i++) {
+        generator->state[i] = splitmix64(&seed);
+    }
+
+    double total = 0;
+    for (int k = 0; k < config->accounts; k++) {
+        total += pow(k + 1, -config->zipf_exponent);
+        generator->sender_cdf[k] = total;
+    }
+    for (int k = 0; k < config->accounts; k++) {
+        generator->sender_cdf[k] /= total;
+    }
+    return generator;
+}
+
+// First rank whose cumulative weight reaches u
+static int pick_sender(LoadGenerator* generator) {
+    double u = next_uniform(generator);
+    int low = 0, high = generator->config.accounts - 1;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (generator->sender_cdf[middle] < u) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+// Log-normal amount rounded to the cent, between 0.01 and 1,000,000 DA
+static amount_t pick_amount(LoadGenerator* generator) {
+    double u1 = 1.0 - next_uniform(generator);   // (0, 1], keeps log() finite
+    double u2 = next_uniform(generator);
+    double z = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+
+    double median = (double)generator->config.median_amount / AMOUNT_SCALE;
+    double cents = round(median * exp(generator->config.amount_sigma * z) * 100.0);
+    if (cents < 1) cents = 1;
+    if (cents > 1e8) cents = 1e8;
+    return (amount_t)cents * (AMOUNT_SCALE / 100);
+}
+
+int next_transaction(LoadGenerator* generator, char* output, size_t size) {
+    int accounts = generator->config.accounts;
+    int sender = pick_sender(generator);
+    int receiver = (int)(next_random(generator) % (uint64_t)(accounts - 1));
+    if (receiver >= sender) receiver++;
+
+    char amount[AMOUNT_STRING_SIZE];
+    format_amount(pick_amount(generator), amount, sizeof(amount));
+    int length = snprintf(output, size, "user%06d sends %s DA to user%06d", sender, amount, receiver);
+    return length >= 0 && (size_t)length < size ? BC_OK : BC_ERR_INVALID_ARG;
+}
+
+void free_load_generator(LoadGenerator* generator) {
+    if (generator == NULL) return;
+
+    free(generator->sender_cdf);
+    free(generator);
+}
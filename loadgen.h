@@ -0,0 +1,32 @@
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "amount.h"
+
+// Deterministic transaction stream: the same configuration and seed always
+// produce the same transactions. Senders follow a Zipf distribution over the
+// accounts (rank k is picked with weight 1 / (k + 1)^zipf_exponent),
+// receivers are uniform, and amounts are log-normal around median_amount,
+// rounded to the cent. Start from init_load_config() and override fields.
+typedef struct {
+    uint64_t seed;
+    int accounts;              // Distinct account names, at least 2
+    double zipf_exponent;      // 0 for uniform senders, ~1 for a few hot accounts
+    amount_t median_amount;
+    double amount_sigma;       // Standard deviation of ln(amount)
+} LoadConfig;
+
+typedef struct LoadGenerator LoadGenerator;
+
+void init_load_config(LoadConfig* config);
+LoadGenerator* create_load_generator(const LoadConfig* config);  // NULL on invalid config or allocation failure
+
+// Write the next transaction as "Sender sends Amount DA to Receiver", the
+// input format of parse_transaction(); returns BC_OK or BC_ERR_INVALID_ARG if
+// size is too small
+int next_transaction(LoadGenerator* generator, char* output, size_t size);
+void free_load_generator(LoadGenerator* generator);
+
+#endif
@@ -0,0 +1,45 @@
+#include <stdio.h>
+#include <stdarg.h>
+#include "logger.h"
+
+static LogCallback log_callback = NULL;
+static LogLevel log_min_level = BC_LOG_INFO;
+static void* log_user_data = NULL;
+
+void set_log_callback(LogCallback callback, LogLevel min_level, void* user_data) {
+    log_callback = callback;
+    log_min_level = min_level;
+    log_user_data = user_data;
+}
+
+void log_message(LogLevel level, const char* format, ...) {
+    if (log_callback == NULL || level < log_min_level) {
+        return;
+    }
+
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    log_callback(level, message, log_user_data);
+}
+
+const char* status_string(int status) {
+    switch (status) {
+        case BC_OK: return "ok";
+        case BC_ERR_NOMEM: return "memory allocation error";
+        case BC_ERR_INVALID_TX: return "invalid transaction";
+        case BC_ERR_BLOCK_FULL: return "transaction limit reached";
+        case BC_ERR_PRUNED: return "block body has been pruned";
+        case BC_ERR_INTEGRITY: return "integrity check failed";
+        case BC_ERR_IO: return "I/O error";
+        case BC_ERR_INVALID_ARG: return "invalid argument";
+        case BC_ERR_FORMAT: return "malformed file";
+        case BC_ERR_SIGNATURE: return "invalid signature";
+        case BC_ERR_OVERFLOW: return "amount overflow";
+        case BC_ERR_REPLAY: return "replayed transaction nonce";
+        default: return "unknown error";
+    }
+}
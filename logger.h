@@ -0,0 +1,35 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+// Status codes returned by the core library instead of printing or exiting
+typedef enum {
+    BC_OK = 0,
+    BC_ERR_NOMEM = -1,
+    BC_ERR_INVALID_TX = -2,
+    BC_ERR_BLOCK_FULL = -3,
+    BC_ERR_PRUNED = -4,
+    BC_ERR_INTEGRITY = -5,
+    BC_ERR_IO = -6,
+    BC_ERR_INVALID_ARG = -7,
+    BC_ERR_FORMAT = -8,
+    BC_ERR_SIGNATURE = -9,
+    BC_ERR_OVERFLOW = -10,
+    BC_ERR_REPLAY = -11
+} BlockchainStatus;
+
+typedef enum {
+    BC_LOG_DEBUG,
+    BC_LOG_INFO,
+    BC_LOG_WARN,
+    BC_LOG_ERROR
+} LogLevel;
+
+// The core is silent unless a callback is installed; messages below
+// min_level are dropped before they are formatted.
+typedef void (*LogCallback)(LogLevel level, const char* message, void* user_data);
+
+void set_log_callback(LogCallback callback, LogLevel min_level, void* user_data);
+void log_message(LogLevel level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+const char* status_string(int status);
+
+#endif
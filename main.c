@@ -1,9 +1,22 @@
 #include <stdio.h>
 #include "blockchain.h"
 #include "ui.h"
+#include "logger.h"
+#include "cli.h"
 
-int main() {
+int main(int argc, char** argv) {
+    // Any argument selects the headless batch mode
+    if (argc > 1) {
+        return run_cli(argc, argv);
+    }
+    
+    set_log_callback(console_log, BC_LOG_INFO, NULL);
+    
     Blockchain* blockchain = init_blockchain();
+    if (blockchain == NULL) {
+        fprintf(stderr, "Memory allocation error\n");
+        return 1;
+    }
     printf("Welcome to Blockchain Demo\n");
     printf("A genesis block has been created automatically.\n");
     
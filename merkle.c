@@ -4,12 +4,14 @@
 #include "merkle.h"
 #include "utils.h"
 #include "transaction.h"
+#include "metrics.h"
+#include "logger.h"
+#include "alloc.h"
 
 MerkleNode* create_merkle_node(const char* data) {
-    MerkleNode* node = (MerkleNode*)malloc(sizeof(MerkleNode));
+    MerkleNode* node = (MerkleNode*)tracked_malloc(MEM_TAG_MERKLE, sizeof(MerkleNode));
     if (node == NULL) {
-        printf("Memory error\n");
-        exit(1);
+        return NULL;
     }
     
     sha256_hash(data, node->hash);
@@ -19,7 +21,14 @@ MerkleNode* create_merkle_node(const char* data) {
     return node;
 }
 
-MerkleNode* build_merkle_tree(char transactions[][256], int count) {
+// Libérer des sous-arbres encore sans parent après un échec d'allocation
+static void free_merkle_nodes(MerkleNode** nodes, int from, int to) {
+    for (int i = from; i < to; i++) {
+        free_merkle_tree(nodes[i]);
+    }
+}
+
+MerkleNode* build_merkle_tree(char transactions[][TX_STRING_SIZE], int count) {
     if (count == 0) return NULL;
     
     // Allouer l'espace pour les nœuds feuilles
@@ -27,20 +36,20 @@ MerkleNode* build_merkle_tree(char transactions[][256], int count) {
     // S'assurer d'avoir assez d'espace si nous avons un nombre impair de transactions
     if (n % 2 == 1) n++;
     
-    MerkleNode** leaf_nodes = (MerkleNode**)malloc(n * sizeof(MerkleNode*));
+    MerkleNode** leaf_nodes = (MerkleNode**)tracked_malloc(MEM_TAG_MERKLE, n * sizeof(MerkleNode*));
     if (leaf_nodes == NULL) {
-        printf("Memory allocation error\n");
-        exit(1);
+        return NULL;
     }
     
     // Créer les nœuds feuilles
-    for (int i = 0; i < count; i++) {
-        leaf_nodes[i] = create_merkle_node(transactions[i]);
-    }
-    
-    // Dupliquer la dernière transaction si nombre impair
-    if (count % 2 == 1) {
-        leaf_nodes[count] = create_merkle_node(transactions[count-1]);
+    for (int i = 0; i < n; i++) {
+        // Dupliquer la dernière transaction si nombre impair
+        leaf_nodes[i] = create_merkle_node(transactions[i < count ? i : count - 1]);
+        if (leaf_nodes[i] == NULL) {
+            free_merkle_nodes(leaf_nodes, 0, i);
+            tracked_free(leaf_nodes);
+            return NULL;
+        }
     }
     
     int level_size = n;
@@ -49,17 +58,24 @@ MerkleNode* build_merkle_tree(char transactions[][256], int count) {
     // Construire l'arbre niveau par niveau
     while (level_size > 1) {
         int next_level_size = (level_size + 1) / 2;
-        MerkleNode** next_level = (MerkleNode**)malloc(next_level_size * sizeof(MerkleNode*));
+        MerkleNode** next_level = (MerkleNode**)tracked_malloc(MEM_TAG_MERKLE, next_level_size * sizeof(MerkleNode*));
         if (next_level == NULL) {
-            printf("Memory allocation error\n");
-            exit(1);
+            free_merkle_nodes(current_level, 0, level_size);
+            if (current_level != leaf_nodes) tracked_free(current_level);
+            tracked_free(leaf_nodes);
+            return NULL;
         }
         
         for (int i = 0; i < level_size; i += 2) {
-            MerkleNode* parent = (MerkleNode*)malloc(sizeof(MerkleNode));
+            MerkleNode* parent = (MerkleNode*)tracked_malloc(MEM_TAG_MERKLE, sizeof(MerkleNode));
             if (parent == NULL) {
-                printf("Memory allocation error\n");
-                exit(1);
+                // Les parents déjà créés possèdent current_level[0..i)
+                free_merkle_nodes(next_level, 0, i / 2);
+                free_merkle_nodes(current_level, i, level_size);
+                tracked_free(next_level);
+                if (current_level != leaf_nodes) tracked_free(current_level);
+                tracked_free(leaf_nodes);
+                return NULL;
             }
             
             parent->left = current_level[i];
@@ -80,7 +96,7 @@ MerkleNode* build_merkle_tree(char transactions[][256], int count) {
         
         // Libérer le niveau actuel mais pas les nœuds eux-mêmes
         if (current_level != leaf_nodes) {
-            free(current_level);
+            tracked_free(current_level);
         }
         
         current_level = next_level;
@@ -94,8 +110,10 @@ MerkleNode* build_merkle_tree(char transactions[][256], int count) {
     }
     
     // Libérer le dernier tableau de pointeurs
-    free(current_level);
-    free(leaf_nodes);
+    if (current_level != leaf_nodes) {
+        tracked_free(current_level);
+    }
+    tracked_free(leaf_nodes);
     
     return root;
 }
@@ -103,32 +121,46 @@ MerkleNode* build_merkle_tree(char transactions[][256], int count) {
 void free_merkle_tree(MerkleNode* node) {
     if (node == NULL) return;
     
-    // Vérifier si les nœuds enfants existent avant de les libérer
-    if (node->left != NULL && node->left != node->right) {
-        free_merkle_tree(node->left);
-    }
-    
-    if (node->right != NULL && node->left != node->right) {
+    // Un nœud auto-référencé ne possède son enfant qu'une seule fois
+    free_merkle_tree(node->left);
+    if (node->right != node->left) {
         free_merkle_tree(node->right);
     }
     
-    free(node);
+    tracked_free(node);
 }
 
-void get_merkle_root(Block* block) {
+// Root of the block body into output, leaving the block untouched. The body
+// must not have been pruned.
+int compute_merkle_root(const Block* block, char output[65]) {
     if (block->transaction_count == 0) {
-        strcpy(block->merkle_root, "0000000000000000000000000000000000000000000000000000000000000000");
-        return;
+        strcpy(output, "0000000000000000000000000000000000000000000000000000000000000000");
+        return BC_OK;
     }
     
-    char transaction_strings[10][256];
+    METRIC_TIMER_START(timer);
+    char transaction_strings[MAX_TRANSACTIONS][TX_STRING_SIZE];
     for (int i = 0; i < block->transaction_count; i++) {
         transaction_to_string(&block->transactions[i], transaction_strings[i], sizeof(transaction_strings[i]));
     }
 
     MerkleNode* root = build_merkle_tree(transaction_strings, block->transaction_count);
+    if (root == NULL) {
+        return BC_ERR_NOMEM;
+    }
 
-    strcpy(block->merkle_root, root->hash);
+    strcpy(output, root->hash);
     
     free_merkle_tree(root);
+    METRIC_INC(METRIC_MERKLE_REBUILDS);
+    METRIC_TIMER_STOP(timer, METRIC_HIST_MERKLE_REBUILD);
+    return BC_OK;
+}
+
+int get_merkle_root(Block* block) {
+    // A pruned block keeps the root it was sealed with; there is nothing to rebuild from
+    if (is_block_pruned(block)) {
+        return BC_OK;
+    }
+    return compute_merkle_root(block, block->merkle_root);
 }
@@ -10,8 +10,9 @@ typedef struct MerkleNode {
 } MerkleNode;
 
 MerkleNode* create_merkle_node(const char* data);
-MerkleNode* build_merkle_tree(char transactions[][256], int count);
+MerkleNode* build_merkle_tree(char transactions[][TX_STRING_SIZE], int count);
 void free_merkle_tree(MerkleNode* node);
-void get_merkle_root(Block* block);
+int compute_merkle_root(const Block* block, char output[65]);
+int get_merkle_root(Block* block);
 
 #endif
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include "metrics.h"
+
+#ifndef BLOCKCHAIN_NO_METRICS
+static const char* counter_names[METRIC_COUNTER_COUNT][2] = {
+    {"blockchain_transactions_parsed_total", "Transactions successfully parsed."},
+    {"blockchain_transactions_rejected_total", "Transactions rejected by parsing or block limits."},
+    {"blockchain_transactions_added_total", "Transactions added to a block."},
+    {"blockchain_hashes_computed_total", "SHA-256 digests computed."},
+    {"blockchain_merkle_rebuilds_total", "Merkle roots rebuilt from a block body."},
+    {"blockchain_blocks_sealed_total", "Blocks linked into a chain."},
+    {"blockchain_verifications_total", "Full chain integrity verifications."},
+    {"blockchain_verification_failures_total", "Chain verifications that found tampering."},
+    {"blockchain_bloom_skips_total", "Block scans skipped by the account Bloom filter."},
+    {"blockchain_bloom_false_positives_total", "Block scans where the Bloom filter matched but the account was absent."},
+    {"blockchain_header_midstate_hits_total", "Header hashes that reused the cached SHA-256 midstate."},
+    {"blockchain_sealer_stalls_total", "Block submissions that waited for room in the sealer queue."},
+};
+
+static const char* histogram_names[METRIC_HISTOGRAM_COUNT][2] = {
+    {"blockchain_transaction_parse_seconds", "Time spent parsing one transaction."},
+    {"blockchain_merkle_rebuild_seconds", "Time spent rebuilding one Merkle root."},
+    {"blockchain_block_hash_seconds", "Time spent hashing one block."},
+    {"blockchain_verification_seconds", "Time spent verifying a whole chain."},
+};
+#endif
+
+typedef struct {
+    uint64_t buckets[METRIC_BUCKETS + 1];
+    uint64_t sum_ns;
+    uint64_t count;
+} Histogram;
+
+typedef struct MetricsShard {
+    uint64_t counters[METRIC_COUNTER_COUNT];
+    Histogram histograms[METRIC_HISTOGRAM_COUNT];
+    int in_use;
+    struct MetricsShard* next;
+} MetricsShard;
+
+// Shards are never freed: a thread that exits hands its shard back for
+// reuse, so its counts stay in the totals and memory is bounded by the
+// peak number of live threads.
+static MetricsShard* shards = NULL;
+static pthread_mutex_t shards_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t shard_key;
+static pthread_once_t shard_key_once = PTHREAD_ONCE_INIT;
+
+// Relaxed loads/stores: only the owning thread writes a shard, the dumper may read concurrently
+#define LOAD(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define BUMP(x, n) __atomic_store_n(&(x), LOAD(x) + (n), __ATOMIC_RELAXED)
+
+static void release_shard(void* arg) {
+    MetricsShard* shard = (MetricsShard*)arg;
+    pthread_mutex_lock(&shards_lock);
+    shard->in_use = 0;
+    pthread_mutex_unlock(&shards_lock);
+}
+
+static void create_shard_key() {
+    pthread_key_create(&shard_key, release_shard);
+}
+
+static MetricsShard* acquire_shard() {
+    pthread_once(&shard_key_once, create_shard_key);
+
+    pthread_mutex_lock(&shards_lock);
+    MetricsShard* shard = shards;
+    while (shard != NULL && shard->in_use) {
+        shard = shard->next;
+    }
+    if (shard == NULL) {
+        shard = (MetricsShard*)calloc(1, sizeof(MetricsShard));
+        if (shard == NULL) {
+            pthread_mutex_unlock(&shards_lock);
+            return NULL;
+        }
+        shard->next = shards;
+        shards = shard;
+    }
+    shard->in_use = 1;
+    pthread_mutex_unlock(&shards_lock);
+
+    pthread_setspecific(shard_key, shard);
+    return shard;
+}
+
+static __thread MetricsShard* local_shard = NULL;
+
+static inline MetricsShard* get_shard() {
+    if (local_shard == NULL) {
+        local_shard = acquire_shard();
+    }
+    return local_shard;
+}
+
+uint64_t metrics_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void metrics_add(MetricCounter counter, uint64_t n) {
+    MetricsShard* shard = get_shard();
+    if (shard == NULL) return;
+
+    BUMP(shard->counters[counter], n);
+}
+
+void metrics_observe_ns(MetricHistogram histogram, uint64_t ns) {
+    MetricsShard* shard = get_shard();
+    if (shard == NULL) return;
+
+    int bucket = 0;
+    if (ns > (1ull << METRIC_MIN_BUCKET_LOG2)) {
+        // Smallest i with ns <= 2^(i + MIN): ceil(log2(ns)) - MIN
+        bucket = 64 - __builtin_clzll(ns - 1) - METRIC_MIN_BUCKET_LOG2;
+        if (bucket > METRIC_BUCKETS) bucket = METRIC_BUCKETS;
+    }
+
+    Histogram* h = &shard->histograms[histogram];
+    BUMP(h->buckets[bucket], 1);
+    BUMP(h->sum_ns, ns);
+    BUMP(h->count, 1);
+}
+
+uint64_t metrics_counter_value(MetricCounter counter) {
+    uint64_t total = 0;
+
+    pthread_mutex_lock(&shards_lock);
+    for (MetricsShard* shard = shards; shard != NULL; shard = shard->next) {
+        total += LOAD(shard->counters[counter]);
+    }
+    pthread_mutex_unlock(&shards_lock);
+
+    return total;
+}
+
+void metrics_reset() {
+    pthread_mutex_lock(&shards_lock);
+    for (MetricsShard* shard = shards; shard != NULL; shard = shard->next) {
+        memset(shard->counters, 0, sizeof(shard->counters));
+        memset(shard->histograms, 0, sizeof(shard->histograms));
+    }
+    pthread_mutex_unlock(&shards_lock);
+}
+
+// Prometheus text exposition format, summed over all thread shards
+void metrics_write(FILE* output) {
+#ifdef BLOCKCHAIN_NO_METRICS
+    fprintf(output, "# metrics disabled in this build\n");
+#else
+    uint64_t counters[METRIC_COUNTER_COUNT] = {0};
+    Histogram histograms[METRIC_HISTOGRAM_COUNT];
+    memset(histograms, 0, sizeof(histograms));
+
+    pthread_mutex_lock(&shards_lock);
+    for (MetricsShard* shard = shards; shard != NULL; shard = shard->next) {
+        for (int c = 0; c < METRIC_COUNTER_COUNT; c++) {
+            counters[c] += LOAD(shard->counters[c]);
+        }
+        for (int h = 0; h < METRIC_HISTOGRAM_COUNT; h++) {
+            for (int b = 0; b <= METRIC_BUCKETS; b++) {
+                histograms[h].buckets[b] += LOAD(shard->histograms[h].buckets[b]);
+            }
+            histograms[h].sum_ns += LOAD(shard->histograms[h].sum_ns);
+            histograms[h].count += LOAD(shard->histograms[h].count);
+        }
+    }
+    pthread_mutex_unlock(&shards_lock);
+
+    for (int c = 0; c < METRIC_COUNTER_COUNT; c++) {
+        fprintf(output, "# HELP %s %s\n", counter_names[c][0], counter_names[c][1]);
+        fprintf(output, "# TYPE %s counter\n", counter_names[c][0]);
+        fprintf(output, "%s %llu\n", counter_names[c][0], (unsigned long long)counters[c]);
+    }
+
+    for (int h = 0; h < METRIC_HISTOGRAM_COUNT; h++) {
+        const char* name = histogram_names[h][0];
+        fprintf(output, "# HELP %s %s\n", name, histogram_names[h][1]);
+        fprintf(output, "# TYPE %s histogram\n", name);
+
+        uint64_t cumulative = 0;
+        for (int b = 0; b < METRIC_BUCKETS; b++) {
+            cumulative += histograms[h].buckets[b];
+            double bound = (double)(1ull << (b + METRIC_MIN_BUCKET_LOG2)) / 1e9;
+            fprintf(output, "%s_bucket{le=\"%g\"} %llu\n", name, bound, (unsigned long long)cumulative);
+        }
+        cumulative += histograms[h].buckets[METRIC_BUCKETS];
+        fprintf(output, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)cumulative);
+        fprintf(output, "%s_sum %.9f\n", name, histograms[h].sum_ns / 1e9);
+        fprintf(output, "%s_count %llu\n", name, (unsigned long long)histograms[h].count);
+    }
+#endif
+}
+
+int metrics_dump_file(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return 0;
+    }
+
+    metrics_write(file);
+    int ok = !ferror(file);
+    fclose(file);
+    return ok;
+}
+
+// Write the exposition to an already open descriptor, e.g. an accepted socket
+int metrics_dump_fd(int fd) {
+    char* text = NULL;
+    size_t size = 0;
+    FILE* buffer = open_memstream(&text, &size);
+    if (buffer == NULL) {
+        return 0;
+    }
+    metrics_write(buffer);
+    fclose(buffer);
+
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = write(fd, text + written, size - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            free(text);
+            return 0;
+        }
+        written += n;
+    }
+
+    free(text);
+    return 1;
+}
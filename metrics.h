@@ -0,0 +1,66 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Hot-path counters and latency histograms. Every thread updates its own
+// shard without locking; the shards are summed when the metrics are dumped.
+// Building with -DBLOCKCHAIN_NO_METRICS compiles every probe out.
+
+typedef enum {
+    METRIC_TX_PARSED,
+    METRIC_TX_REJECTED,
+    METRIC_TX_ADDED,
+    METRIC_HASHES_COMPUTED,
+    METRIC_MERKLE_REBUILDS,
+    METRIC_BLOCKS_SEALED,
+    METRIC_VERIFICATIONS,
+    METRIC_VERIFICATION_FAILURES,
+    METRIC_BLOOM_SKIPS,
+    METRIC_BLOOM_FALSE_POSITIVES,
+    METRIC_MIDSTATE_HITS,
+    METRIC_SEALER_STALLS,
+    METRIC_COUNTER_COUNT
+} MetricCounter;
+
+typedef enum {
+    METRIC_HIST_TX_PARSE,
+    METRIC_HIST_MERKLE_REBUILD,
+    METRIC_HIST_BLOCK_HASH,
+    METRIC_HIST_VERIFICATION,
+    METRIC_HISTOGRAM_COUNT
+} MetricHistogram;
+
+// Bucket i counts observations of at most 2^(i + METRIC_MIN_BUCKET_LOG2) ns,
+// i.e. 256ns .. ~4.3s, plus a final +Inf bucket
+#define METRIC_MIN_BUCKET_LOG2 8
+#define METRIC_BUCKETS 25
+
+#ifdef BLOCKCHAIN_NO_METRICS
+
+#define METRIC_INC(counter) ((void)0)
+#define METRIC_ADD(counter, n) ((void)0)
+#define METRIC_TIMER_START(timer) ((void)0)
+#define METRIC_TIMER_STOP(timer, histogram) ((void)0)
+
+#else
+
+void metrics_add(MetricCounter counter, uint64_t n);
+void metrics_observe_ns(MetricHistogram histogram, uint64_t ns);
+uint64_t metrics_now_ns();
+
+#define METRIC_INC(counter) metrics_add((counter), 1)
+#define METRIC_ADD(counter, n) metrics_add((counter), (n))
+#define METRIC_TIMER_START(timer) uint64_t timer = metrics_now_ns()
+#define METRIC_TIMER_STOP(timer, histogram) metrics_observe_ns((histogram), metrics_now_ns() - (timer))
+
+#endif
+
+uint64_t metrics_counter_value(MetricCounter counter);
+void metrics_reset();
+void metrics_write(FILE* output);
+int metrics_dump_file(const char* path);
+int metrics_dump_fd(int fd);
+
+#endif
@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "persist.h"
+#include "snapshot.h"
+#include "logger.h"
+#include "codec.h"
+#include "alloc.h"
+
+static int write_bytes(FILE* file, const void* data, size_t size) {
+    return fwrite(data, 1, size, file) == size;
+}
+
+static int read_bytes(FILE* file, void* data, size_t size) {
+    return fread(data, 1, size, file) == size;
+}
+
+static int write_block(FILE* file, Block* block, int codec) {
+    int64_t timestamp = (int64_t)block->timestamp;
+    uint8_t has_body = !is_block_pruned(block);
+
+    if (!write_bytes(file, &block->index, sizeof(block->index))
+        || !write_bytes(file, &timestamp, sizeof(timestamp))
+        || !write_bytes(file, block->previous_hash, 64)
+        || !write_bytes(file, block->merkle_root, 64)
+        || !write_bytes(file, block->current_hash, 64)
+        || !write_bytes(file, &block->transaction_count, sizeof(block->transaction_count))
+        || !write_bytes(file, &has_body, sizeof(has_body))) {
+        return 0;
+    }
+
+    // A body carries its own account filter; only pruned blocks store theirs
+    if (!has_body) {
+        return write_bytes(file, block->accounts.bits, sizeof(block->accounts.bits));
+    }
+
+    unsigned char body[BODY_MAX_ENCODED_SIZE];
+    size_t body_size;
+    if (encode_block_body(block, codec, body, sizeof(body), &body_size) != BC_OK) {
+        return 0;
+    }
+    uint16_t size = (uint16_t)body_size;
+    return write_bytes(file, &size, sizeof(size)) && write_bytes(file, body, body_size);
+}
+
+// Version 4 bodies: fixed-width transactions after the account filter
+static int read_raw_body(FILE* file, Block* block) {
+    for (int i = 0; i < block->transaction_count; i++) {
+        Transaction* tx = &block->transactions[i];
+        int32_t amount;
+        if (!read_bytes(file, tx->sender, sizeof(tx->sender))
+            || !read_bytes(file, tx->receiver, sizeof(tx->receiver))
+            || !read_bytes(file, &amount, sizeof(amount))) {
+            return BC_ERR_FORMAT;
+        }
+        tx->amount = DA(amount);
+        tx->nonce = 0;
+
+        uint8_t has_signature;
+        if (!read_bytes(file, &has_signature, sizeof(has_signature))) {
+            return BC_ERR_FORMAT;
+        }
+        tx->has_signature = has_signature != 0;
+        if (has_signature
+            && (!read_bytes(file, tx->public_key, PUBLIC_KEY_SIZE)
+                || !read_bytes(file, tx->signature, SIGNATURE_SIZE))) {
+            return BC_ERR_FORMAT;
+        }
+        tx->sender[sizeof(tx->sender) - 1] = '\0';
+        tx->receiver[sizeof(tx->receiver) - 1] = '\0';
+    }
+    return BC_OK;
+}
+
+static int read_encoded_body(FILE* file, Block* block) {
+    uint16_t size;
+    unsigned char body[BODY_MAX_ENCODED_SIZE];
+    if (!read_bytes(file, &size, sizeof(size)) || size > sizeof(body) || !read_bytes(file, body, size)) {
+        return BC_ERR_FORMAT;
+    }
+
+    int transaction_count = block->transaction_count;
+    int status = decode_block_body(body, size, block);
+    if (status == BC_OK && block->transaction_count != transaction_count) {
+        status = BC_ERR_FORMAT;
+    }
+    if (status == BC_OK) {
+        build_block_bloom(block);
+    }
+    return status;
+}
+
+// Before version 6 amounts were whole DA; convert them to fixed point
+static int scale_whole_amount(amount_t* amount) {
+    return __builtin_mul_overflow(*amount, AMOUNT_SCALE, amount) ? BC_ERR_FORMAT : BC_OK;
+}
+
+static int read_block(FILE* file, uint32_t version, Block** out) {
+    Block header;
+    int64_t timestamp;
+    uint8_t has_body;
+
+    if (!read_bytes(file, &header.index, sizeof(header.index))
+        || !read_bytes(file, &timestamp, sizeof(timestamp))
+        || !read_bytes(file, header.previous_hash, 64)
+        || !read_bytes(file, header.merkle_root, 64)
+        || !read_bytes(file, header.current_hash, 64)
+        || !read_bytes(file, &header.transaction_count, sizeof(header.transaction_count))
+        || !read_bytes(file, &has_body, sizeof(has_body))) {
+        return BC_ERR_FORMAT;
+    }
+    if (header.transaction_count < 0 || header.transaction_count > MAX_TRANSACTIONS) {
+        return BC_ERR_FORMAT;
+    }
+
+    Block* block = create_block(header.index, "");
+    if (block == NULL) {
+        return BC_ERR_NOMEM;
+    }
+    block->timestamp = (time_t)timestamp;
+    memcpy(block->previous_hash, header.previous_hash, 64);
+    memcpy(block->merkle_root, header.merkle_root, 64);
+    memcpy(block->current_hash, header.current_hash, 64);
+    block->transaction_count = header.transaction_count;
+
+    int status = BC_OK;
+    if (version < 5 || !has_body) {
+        if (!read_bytes(file, block->accounts.bits, sizeof(block->accounts.bits))) {
+            status = BC_ERR_FORMAT;
+        }
+    }
+    if (status == BC_OK && has_body) {
+        status = version < 5 ? read_raw_body(file, block) : read_encoded_body(file, block);
+    }
+    for (int i = 0; status == BC_OK && has_body && version == 5 && i < block->transaction_count; i++) {
+        status = scale_whole_amount(&block->transactions[i].amount);
+    }
+    if (status != BC_OK) {
+        free_block(block);
+        return status;
+    }
+
+    if (!has_body) {
+        prune_block(block);
+    }
+    *out = block;
+    return BC_OK;
+}
+
+static int write_snapshot(FILE* file, const StateSnapshot* snapshot) {
+    char state_root[65];
+    if (calculate_state_root(snapshot, state_root) != BC_OK
+        || !write_bytes(file, &snapshot->height, sizeof(snapshot->height))
+        || !write_bytes(file, snapshot->block_hash, 64)
+        || !write_bytes(file, state_root, 64)
+        || !write_bytes(file, &snapshot->count, sizeof(snapshot->count))) {
+        return 0;
+    }
+    return write_bytes(file, snapshot->balances, snapshot->count * sizeof(AccountBalance));
+}
+
+// The snapshot is checked like load_snapshot() does, and must sit at the
+// pruning height of the chain read before it. Files before version 8 carry
+// no state root, so only the order and the anchor are checked for them.
+static int read_snapshot(FILE* file, uint32_t version, Blockchain* blockchain) {
+    int height, count;
+    char block_hash[65] = {0};
+    char state_root[65] = {0};
+
+    if (!read_bytes(file, &height, sizeof(height))
+        || !read_bytes(file, block_hash, 64)
+        || (version >= 8 && !read_bytes(file, state_root, 64))
+        || !read_bytes(file, &count, sizeof(count))
+        || count < 0) {
+        return BC_ERR_FORMAT;
+    }
+
+    StateSnapshot* snapshot = alloc_snapshot(count);
+    if (snapshot == NULL) {
+        return BC_ERR_NOMEM;
+    }
+    // Before version 7 the records had no nonce
+    int ok = 1;
+    if (version < 7) {
+        for (int i = 0; ok && i < count; i++) {
+            AccountBalance* entry = &snapshot->balances[i];
+            ok = read_bytes(file, entry->account, sizeof(entry->account))
+              && read_bytes(file, &entry->balance, sizeof(entry->balance));
+            entry->nonce = 0;
+        }
+    } else {
+        ok = read_bytes(file, snapshot->balances, count * sizeof(AccountBalance));
+    }
+    if (!ok) {
+        free_snapshot(snapshot);
+        return BC_ERR_FORMAT;
+    }
+    for (int i = 0; i < count; i++) {
+        snapshot->balances[i].account[63] = '\0';
+        if (version < 6 && scale_whole_amount(&snapshot->balances[i].balance) != BC_OK) {
+            free_snapshot(snapshot);
+            return BC_ERR_FORMAT;
+        }
+    }
+
+    snapshot->height = height;
+    strcpy(snapshot->block_hash, block_hash);
+    snapshot->count = count;
+
+    int status = check_snapshot(snapshot, version >= 8 ? state_root : NULL);
+    if (status == BC_OK && (height != blockchain->pruned_height || !is_snapshot_anchored(snapshot, blockchain))) {
+        status = BC_ERR_FORMAT;
+    }
+    if (status != BC_OK) {
+        free_snapshot(snapshot);
+        return status;
+    }
+    blockchain->snapshot = snapshot;
+    return BC_OK;
+}
+
+// Write the chain to an open stream; returns 1 on success
+static int write_chain(FILE* file, Blockchain* blockchain, int codec) {
+    uint32_t version = CHAIN_FILE_VERSION;
+    uint8_t has_snapshot = blockchain->snapshot != NULL;
+    int ok = write_bytes(file, CHAIN_FILE_MAGIC, 4)
+          && write_bytes(file, &version, sizeof(version))
+          && write_bytes(file, &blockchain->length, sizeof(blockchain->length))
+          && write_bytes(file, &blockchain->pruned_height, sizeof(blockchain->pruned_height))
+          && write_bytes(file, &has_snapshot, sizeof(has_snapshot));
+
+    for (int i = 0; ok && i < blockchain->length; i++) {
+        ok = write_block(file, blockchain->blocks[i], codec);
+    }
+    if (ok && has_snapshot) {
+        ok = write_snapshot(file, blockchain->snapshot);
+    }
+    return ok;
+}
+
+static int read_chain(FILE* file, Blockchain** out) {
+    char magic[4];
+    uint32_t version;
+    int length, pruned_height;
+    uint8_t has_snapshot;
+    if (!read_bytes(file, magic, 4) || memcmp(magic, CHAIN_FILE_MAGIC, 4) != 0
+        || !read_bytes(file, &version, sizeof(version)) || version < CHAIN_FILE_MIN_VERSION || version > CHAIN_FILE_VERSION
+        || !read_bytes(file, &length, sizeof(length))
+        || !read_bytes(file, &pruned_height, sizeof(pruned_height))
+        || !read_bytes(file, &has_snapshot, sizeof(has_snapshot))
+        || length < 1 || pruned_height < 0 || pruned_height > length
+        || (pruned_height > 0) != (has_snapshot != 0)) {
+        return BC_ERR_FORMAT;
+    }
+
+    Blockchain* blockchain = (Blockchain*)tracked_malloc(MEM_TAG_CHAIN, sizeof(Blockchain));
+    if (blockchain == NULL) {
+        return BC_ERR_NOMEM;
+    }
+    blockchain->capacity = length < 10 ? 10 : length;
+    blockchain->length = 0;
+    blockchain->pruned_height = pruned_height;
+    blockchain->snapshot = NULL;
+    blockchain->blocks = (Block**)tracked_malloc(MEM_TAG_CHAIN, blockchain->capacity * sizeof(Block*));
+    if (blockchain->blocks == NULL) {
+        tracked_free(blockchain);
+        return BC_ERR_NOMEM;
+    }
+
+    int status = BC_OK;
+    for (int i = 0; status == BC_OK && i < length; i++) {
+        status = read_block(file, version, &blockchain->blocks[i]);
+        if (status == BC_OK) blockchain->length++;
+    }
+    if (status == BC_OK && has_snapshot) {
+        status = read_snapshot(file, version, blockchain);
+    }
+
+    if (status != BC_OK) {
+        free_blockchain(blockchain);
+        return status;
+    }
+
+    *out = blockchain;
+    return BC_OK;
+}
+
+int save_blockchain(Blockchain* blockchain, const char* path, int codec) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return BC_ERR_IO;
+    }
+
+    int ok = write_chain(file, blockchain, codec);
+    if (fclose(file) != 0) ok = 0;
+    return ok ? BC_OK : BC_ERR_IO;
+}
+
+// Load a chain written by save_blockchain(). The chain is not verified here;
+// callers decide whether to run verify_blockchain_integrity() on it.
+int load_blockchain(const char* path, Blockchain** out) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return BC_ERR_IO;
+    }
+
+    int status = read_chain(file, out);
+    fclose(file);
+    return status;
+}
+
+// Encode the chain in the file format into a malloc'd buffer, e.g. to ship it
+// to a peer. The caller frees *data.
+int serialize_blockchain(Blockchain* blockchain, unsigned char** data, size_t* size, int codec) {
+    char* buffer = NULL;
+    size_t length = 0;
+    FILE* stream = open_memstream(&buffer, &length);
+    if (stream == NULL) {
+        return BC_ERR_NOMEM;
+    }
+
+    int ok = write_chain(stream, blockchain, codec);
+    if (fclose(stream) != 0) ok = 0;
+    if (!ok) {
+        free(buffer);
+        return BC_ERR_NOMEM;
+    }
+
+    *data = (unsigned char*)buffer;
+    *size = length;
+    return BC_OK;
+}
+
+int deserialize_blockchain(const unsigned char* data, size_t size, Blockchain** out) {
+    if (size == 0) {
+        return BC_ERR_FORMAT;
+    }
+    FILE* stream = fmemopen((void*)data, size, "rb");
+    if (stream == NULL) {
+        return BC_ERR_NOMEM;
+    }
+
+    int status = read_chain(stream, out);
+    fclose(stream);
+    return status;
+}
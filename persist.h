@@ -0,0 +1,26 @@
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <stddef.h>
+#include "blockchain.h"
+
+// Binary chain file: every header, the bodies that have not been pruned and
+// the pruning snapshot. Integers are stored in host byte order.
+#define CHAIN_FILE_MAGIC "SBCH"
+#define CHAIN_FILE_VERSION 8   // 2: signatures, 3: account Bloom filters, 4: binary header hashes,
+                               // 5: bodies in the compact encoding of codec.h, 6: fixed-point amounts,
+                               // 7: transaction nonces, 8: snapshot state root
+#define CHAIN_FILE_MIN_VERSION 4  // Older files hold hashes of the former decimal header preimage
+
+// codec is BODY_CODEC_PLAIN or BODY_CODEC_DEFLATE (codec.h) for the block
+// bodies. Deflate rarely shrinks a body of MAX_TRANSACTIONS further once the
+// names are in a dictionary, and its per-call setup dominates the export time,
+// so plain is the default; the loaders read either.
+int save_blockchain(Blockchain* blockchain, const char* path, int codec);
+int load_blockchain(const char* path, Blockchain** out);
+
+// Same format in memory, for node sync
+int serialize_blockchain(Blockchain* blockchain, unsigned char** data, size_t* size, int codec);
+int deserialize_blockchain(const unsigned char* data, size_t size, Blockchain** out);
+
+#endif
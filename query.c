@@ -0,0 +1,164 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include "query.h"
+#include "logger.h"
+
+// Blocks claimed by a worker at a time, and matches buffered per worker
+// before the callback lock is taken
+#define QUERY_CHUNK_BLOCKS 64
+#define QUERY_MATCH_BUFFER 64
+
+typedef struct {
+    const Block* block;
+    const Transaction* tx;
+} Match;
+
+typedef struct {
+    Blockchain* blockchain;
+    const TxQuery* query;
+    TxMatchCallback callback;
+    void* user_data;
+
+    int next_block;          // Shared cursor, advanced atomically
+    int end_block;
+    int stop;
+
+    pthread_mutex_t callback_lock;
+    TxQueryStats stats;      // Merged under callback_lock
+} QueryRun;
+
+void init_tx_query(TxQuery* query) {
+    query->sender = NULL;
+    query->receiver = NULL;
+    query->account = NULL;
+    query->min_amount = AMOUNT_MIN;
+    query->max_amount = AMOUNT_MAX;
+    query->min_height = 0;
+    query->max_height = INT_MAX;
+    query->min_time = LLONG_MIN;
+    query->max_time = LLONG_MAX;
+}
+
+int tx_query_matches(const TxQuery* query, const Block* block, const Transaction* tx) {
+    return block->index >= query->min_height && block->index <= query->max_height
+        && (long long)block->timestamp >= query->min_time && (long long)block->timestamp <= query->max_time
+        && tx->amount >= query->min_amount && tx->amount <= query->max_amount
+        && (query->sender == NULL || strcmp(tx->sender, query->sender) == 0)
+        && (query->receiver == NULL || strcmp(tx->receiver, query->receiver) == 0)
+        && (query->account == NULL || strcmp(tx->sender, query->account) == 0
+            || strcmp(tx->receiver, query->account) == 0);
+}
+
+// Header-only checks: a block failing them cannot hold a match
+static int block_may_match(const TxQuery* query, const Block* block) {
+    if ((long long)block->timestamp < query->min_time || (long long)block->timestamp > query->max_time) {
+        return 0;
+    }
+    const BloomFilter* filter = &block->accounts;
+    return (query->sender == NULL || bloom_might_contain(filter, query->sender))
+        && (query->receiver == NULL || bloom_might_contain(filter, query->receiver))
+        && (query->account == NULL || bloom_might_contain(filter, query->account));
+}
+
+static int flush_matches(QueryRun* run, Match* buffer, int count) {
+    pthread_mutex_lock(&run->callback_lock);
+    for (int i = 0; i < count && !__atomic_load_n(&run->stop, __ATOMIC_RELAXED); i++) {
+        run->stats.matches++;
+        if (run->callback != NULL && run->callback(buffer[i].block, buffer[i].tx, run->user_data)) {
+            __atomic_store_n(&run->stop, 1, __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&run->callback_lock);
+    return !__atomic_load_n(&run->stop, __ATOMIC_RELAXED);
+}
+
+// Each worker claims the next chunk of blocks until the range is exhausted,
+// so a worker that lands on cheap (filtered or pruned) chunks takes more
+static void query_worker(void* arg) {
+    QueryRun* run = (QueryRun*)arg;
+    const TxQuery* query = run->query;
+    Match buffer[QUERY_MATCH_BUFFER];
+    int buffered = 0;
+    TxQueryStats local = {0, 0, 0, 0};
+
+    while (!__atomic_load_n(&run->stop, __ATOMIC_RELAXED)) {
+        int start = __atomic_fetch_add(&run->next_block, QUERY_CHUNK_BLOCKS, __ATOMIC_RELAXED);
+        if (start >= run->end_block) break;
+        int end = start + QUERY_CHUNK_BLOCKS < run->end_block ? start + QUERY_CHUNK_BLOCKS : run->end_block;
+
+        for (int b = start; b < end; b++) {
+            const Block* block = run->blockchain->blocks[b];
+            if (!block_may_match(query, block)) {
+                local.blocks_skipped++;
+                continue;
+            }
+            if (is_block_pruned(block)) {
+                local.blocks_pruned++;
+                continue;
+            }
+
+            local.blocks_scanned++;
+            for (int t = 0; t < block->transaction_count; t++) {
+                if (!tx_query_matches(query, block, &block->transactions[t])) continue;
+
+                buffer[buffered].block = block;
+                buffer[buffered].tx = &block->transactions[t];
+                if (++buffered == QUERY_MATCH_BUFFER) {
+                    flush_matches(run, buffer, buffered);
+                    buffered = 0;
+                }
+            }
+        }
+    }
+    if (buffered > 0) {
+        flush_matches(run, buffer, buffered);
+    }
+
+    pthread_mutex_lock(&run->callback_lock);
+    run->stats.blocks_scanned += local.blocks_scanned;
+    run->stats.blocks_skipped += local.blocks_skipped;
+    run->stats.blocks_pruned += local.blocks_pruned;
+    pthread_mutex_unlock(&run->callback_lock);
+}
+
+// Stream every transaction matching the query to the callback, scanning block
+// ranges on the pool workers and the calling thread. The height bounds select
+// the blocks to visit; timestamps and the account Bloom filters rule out
+// blocks before their body is read. A NULL pool scans on the calling thread.
+int run_tx_query(Blockchain* blockchain, const TxQuery* query, ThreadPool* pool,
+                 TxMatchCallback callback, void* user_data, TxQueryStats* stats) {
+    QueryRun run;
+    run.blockchain = blockchain;
+    run.query = query;
+    run.callback = callback;
+    run.user_data = user_data;
+    run.next_block = query->min_height > 0 ? query->min_height : 0;
+    run.end_block = query->max_height < blockchain->length - 1 ? query->max_height + 1 : blockchain->length;
+    run.stop = 0;
+    memset(&run.stats, 0, sizeof(run.stats));
+    if (pthread_mutex_init(&run.callback_lock, NULL) != 0) {
+        return BC_ERR_NOMEM;
+    }
+
+    int chunks = run.end_block > run.next_block
+               ? (run.end_block - run.next_block + QUERY_CHUNK_BLOCKS - 1) / QUERY_CHUNK_BLOCKS : 0;
+    int helpers = pool != NULL ? thread_pool_size(pool) : 0;
+    if (helpers > chunks - 1) helpers = chunks - 1;
+
+    int submitted = 0;
+    for (int i = 0; i < helpers; i++) {
+        if (thread_pool_submit(pool, query_worker, &run) == BC_OK) submitted++;
+    }
+    query_worker(&run);
+    if (submitted > 0) {
+        thread_pool_wait(pool);
+    }
+
+    pthread_mutex_destroy(&run.callback_lock);
+    if (stats != NULL) {
+        *stats = run.stats;
+    }
+    return BC_OK;
+}
@@ -0,0 +1,37 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "blockchain.h"
+#include "thread_pool.h"
+
+// Conjunction of predicates over the transactions of a chain. Start from
+// init_tx_query(), which matches everything, and narrow the fields you need.
+typedef struct {
+    const char* sender;      // Exact name, NULL for any
+    const char* receiver;    // Exact name, NULL for any
+    const char* account;     // Sender or receiver, NULL for any
+    amount_t min_amount;     // Inclusive bounds
+    amount_t max_amount;
+    int min_height;          // Inclusive block index bounds
+    int max_height;
+    long long min_time;      // Inclusive block timestamp bounds
+    long long max_time;
+} TxQuery;
+
+typedef struct {
+    long matches;
+    int blocks_scanned;      // Bodies whose transactions were evaluated
+    int blocks_skipped;      // Ruled out by the header or the Bloom filter
+    int blocks_pruned;       // In range but without a body to scan
+} TxQueryStats;
+
+// Called once per matching transaction, never concurrently, in no particular
+// order. Return nonzero to stop the scan early.
+typedef int (*TxMatchCallback)(const Block* block, const Transaction* tx, void* user_data);
+
+void init_tx_query(TxQuery* query);
+int tx_query_matches(const TxQuery* query, const Block* block, const Transaction* tx);
+int run_tx_query(Blockchain* blockchain, const TxQuery* query, ThreadPool* pool,
+                 TxMatchCallback callback, void* user_data, TxQueryStats* stats);
+
+#endif
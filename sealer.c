@@ -0,0 +1,180 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "sealer.h"
+#include "block.h"
+#include "metrics.h"
+#include "logger.h"
+
+struct Sealer {
+    Blockchain* blockchain;
+    pthread_t thread;
+
+    // Fixed circular queue; its size is the backpressure bound
+    Block** queue;
+    int capacity;
+    int head;
+    int count;
+
+    int busy;          // A block taken from the queue is being sealed
+    int status;        // First sealing error, BC_OK until then
+    int shutting_down;
+    SealerStats stats;
+
+    pthread_mutex_t lock;
+    pthread_cond_t block_available;
+    pthread_cond_t space_available;
+    pthread_cond_t all_sealed;
+};
+
+// Runs on the worker without the lock: only the worker touches the chain
+static int seal_next(Blockchain* blockchain, Block* block) {
+    Block* tip = blockchain->blocks[blockchain->length - 1];
+    block->index = blockchain->length;
+    strcpy(block->previous_hash, tip->current_hash);
+
+    int status = calculate_block_hash(block);
+    if (status == BC_OK) {
+        status = add_block(blockchain, block);
+    }
+    return status;
+}
+
+static void* sealer_main(void* arg) {
+    Sealer* sealer = (Sealer*)arg;
+
+    pthread_mutex_lock(&sealer->lock);
+    for (;;) {
+        while (sealer->count == 0 && !sealer->shutting_down) {
+            pthread_cond_wait(&sealer->block_available, &sealer->lock);
+        }
+        if (sealer->count == 0 && sealer->shutting_down) {
+            break;
+        }
+
+        Block* block = sealer->queue[sealer->head];
+        sealer->head = (sealer->head + 1) % sealer->capacity;
+        sealer->count--;
+        sealer->busy = 1;
+        int status = sealer->status;
+        pthread_cond_signal(&sealer->space_available);
+        pthread_mutex_unlock(&sealer->lock);
+
+        if (status == BC_OK) {
+            status = seal_next(sealer->blockchain, block);
+            if (status != BC_OK) {
+                log_message(BC_LOG_ERROR, "Sealer: block #%d not linked: %s", block->index, status_string(status));
+            }
+        }
+        if (status != BC_OK) {
+            free_block(block);
+        }
+
+        pthread_mutex_lock(&sealer->lock);
+        sealer->busy = 0;
+        if (status == BC_OK) {
+            sealer->stats.sealed++;
+        } else if (sealer->status == BC_OK) {
+            sealer->status = status;
+        }
+        if (sealer->count == 0) {
+            pthread_cond_broadcast(&sealer->all_sealed);
+        }
+    }
+    pthread_mutex_unlock(&sealer->lock);
+
+    return NULL;
+}
+
+Sealer* create_sealer(Blockchain* blockchain, int queue_capacity) {
+    if (queue_capacity <= 0) queue_capacity = SEALER_DEFAULT_QUEUE;
+
+    Sealer* sealer = (Sealer*)calloc(1, sizeof(Sealer));
+    if (sealer == NULL) {
+        return NULL;
+    }
+    sealer->queue = (Block**)malloc(queue_capacity * sizeof(Block*));
+    if (sealer->queue == NULL) {
+        free(sealer);
+        return NULL;
+    }
+    sealer->blockchain = blockchain;
+    sealer->capacity = queue_capacity;
+    sealer->status = BC_OK;
+
+    pthread_mutex_init(&sealer->lock, NULL);
+    pthread_cond_init(&sealer->block_available, NULL);
+    pthread_cond_init(&sealer->space_available, NULL);
+    pthread_cond_init(&sealer->all_sealed, NULL);
+
+    if (pthread_create(&sealer->thread, NULL, sealer_main, sealer) != 0) {
+        pthread_mutex_destroy(&sealer->lock);
+        pthread_cond_destroy(&sealer->block_available);
+        pthread_cond_destroy(&sealer->space_available);
+        pthread_cond_destroy(&sealer->all_sealed);
+        free(sealer->queue);
+        free(sealer);
+        return NULL;
+    }
+    return sealer;
+}
+
+int sealer_submit(Sealer* sealer, Block* block) {
+    pthread_mutex_lock(&sealer->lock);
+
+    if (sealer->count == sealer->capacity) {
+        sealer->stats.stalls++;
+        METRIC_INC(METRIC_SEALER_STALLS);
+        while (sealer->count == sealer->capacity) {
+            pthread_cond_wait(&sealer->space_available, &sealer->lock);
+        }
+    }
+
+    int status = sealer->status;
+    if (status != BC_OK) {
+        pthread_mutex_unlock(&sealer->lock);
+        free_block(block);
+        return status;
+    }
+
+    sealer->queue[(sealer->head + sealer->count) % sealer->capacity] = block;
+    sealer->count++;
+    sealer->stats.submitted++;
+
+    pthread_cond_signal(&sealer->block_available);
+    pthread_mutex_unlock(&sealer->lock);
+    return BC_OK;
+}
+
+int sealer_flush(Sealer* sealer) {
+    pthread_mutex_lock(&sealer->lock);
+    while (sealer->count > 0 || sealer->busy) {
+        pthread_cond_wait(&sealer->all_sealed, &sealer->lock);
+    }
+    int status = sealer->status;
+    pthread_mutex_unlock(&sealer->lock);
+    return status;
+}
+
+void sealer_stats(Sealer* sealer, SealerStats* stats) {
+    pthread_mutex_lock(&sealer->lock);
+    *stats = sealer->stats;
+    pthread_mutex_unlock(&sealer->lock);
+}
+
+void free_sealer(Sealer* sealer) {
+    if (sealer == NULL) return;
+
+    pthread_mutex_lock(&sealer->lock);
+    sealer->shutting_down = 1;
+    pthread_cond_signal(&sealer->block_available);
+    pthread_mutex_unlock(&sealer->lock);
+    pthread_join(sealer->thread, NULL);
+
+    pthread_mutex_destroy(&sealer->lock);
+    pthread_cond_destroy(&sealer->block_available);
+    pthread_cond_destroy(&sealer->space_available);
+    pthread_cond_destroy(&sealer->all_sealed);
+    free(sealer->queue);
+    free(sealer);
+}
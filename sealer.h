@@ -0,0 +1,33 @@
+#ifndef SEALER_H
+#define SEALER_H
+
+#include "blockchain.h"
+
+#define SEALER_DEFAULT_QUEUE 8
+
+typedef struct Sealer Sealer;
+
+typedef struct {
+    long submitted;
+    long sealed;
+    long stalls;             // Submissions that waited for room in the queue
+} SealerStats;
+
+// Seals blocks on a background thread so the caller can fill the next block
+// while the previous one is hashed. The worker takes blocks in submission
+// order, sets their index and previous hash from the tip, computes the Merkle
+// root and header hash and links them into the chain. The chain belongs to
+// the sealer until sealer_flush() or free_sealer() returns.
+Sealer* create_sealer(Blockchain* blockchain, int queue_capacity);  // <= 0 for SEALER_DEFAULT_QUEUE
+
+// Hand off a block; waits while the queue is full. The sealer owns the block
+// from here on, even on error. Once a block fails to seal, later blocks are
+// dropped and every call returns that status.
+int sealer_submit(Sealer* sealer, Block* block);
+
+// Wait until every submitted block is linked; returns the first error, if any
+int sealer_flush(Sealer* sealer);
+void sealer_stats(Sealer* sealer, SealerStats* stats);
+void free_sealer(Sealer* sealer);   // Flushes, then stops the worker
+
+#endif
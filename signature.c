@@ -0,0 +1,412 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "signature.h"
+#include "snapshot.h"
+#include "utils.h"
+#include "logger.h"
+
+static int extract_public_key(KeyPair* keys) {
+    size_t size = PUBLIC_KEY_SIZE;
+    if (EVP_PKEY_get_raw_public_key(keys->key, keys->public_key, &size) != 1 || size != PUBLIC_KEY_SIZE) {
+        EVP_PKEY_free(keys->key);
+        keys->key = NULL;
+        return BC_ERR_SIGNATURE;
+    }
+    return BC_OK;
+}
+
+int generate_keypair(KeyPair* keys) {
+    keys->key = NULL;
+
+    EVP_PKEY_CTX* ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, NULL);
+    if (ctx == NULL) {
+        return BC_ERR_NOMEM;
+    }
+    int ok = EVP_PKEY_keygen_init(ctx) == 1 && EVP_PKEY_keygen(ctx, &keys->key) == 1;
+    EVP_PKEY_CTX_free(ctx);
+
+    if (!ok) {
+        return BC_ERR_SIGNATURE;
+    }
+    return extract_public_key(keys);
+}
+
+// Deterministic keys, e.g. for reproducible test data
+int keypair_from_seed(KeyPair* keys, const unsigned char seed[KEY_SEED_SIZE]) {
+    keys->key = EVP_PKEY_new_raw_private_key(EVP_PKEY_ED25519, NULL, seed, KEY_SEED_SIZE);
+    if (keys->key == NULL) {
+        return BC_ERR_SIGNATURE;
+    }
+    return extract_public_key(keys);
+}
+
+void free_keypair(KeyPair* keys) {
+    EVP_PKEY_free(keys->key);
+    keys->key = NULL;
+}
+
+int sign_transaction(Transaction* tx, const KeyPair* keys) {
+    char message[TX_STRING_SIZE];
+    transaction_message(tx, message, sizeof(message));
+
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    if (ctx == NULL) {
+        return BC_ERR_NOMEM;
+    }
+
+    size_t size = SIGNATURE_SIZE;
+    int ok = EVP_DigestSignInit(ctx, NULL, NULL, NULL, keys->key) == 1
+          && EVP_DigestSign(ctx, tx->signature, &size, (const unsigned char*)message, strlen(message)) == 1
+          && size == SIGNATURE_SIZE;
+    EVP_MD_CTX_free(ctx);
+
+    if (!ok) {
+        tx->has_signature = 0;
+        return BC_ERR_SIGNATURE;
+    }
+
+    memcpy(tx->public_key, keys->public_key, PUBLIC_KEY_SIZE);
+    tx->has_signature = 1;
+    return BC_OK;
+}
+
+KeyRegistry* create_key_registry() {
+    KeyRegistry* registry = (KeyRegistry*)malloc(sizeof(KeyRegistry));
+    if (registry == NULL) {
+        return NULL;
+    }
+    registry->capacity = 16;
+    registry->count = 0;
+    registry->keys = (AccountKey*)malloc(registry->capacity * sizeof(AccountKey));
+    if (registry->keys == NULL) {
+        free(registry);
+        return NULL;
+    }
+    return registry;
+}
+
+void free_key_registry(KeyRegistry* registry) {
+    if (registry == NULL) return;
+
+    free(registry->keys);
+    free(registry);
+}
+
+// Binary search; returns the slot of the account or the slot it should be inserted at
+static int find_account_key(const KeyRegistry* registry, const char* account, int* found) {
+    int lo = 0, hi = registry->count;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(registry->keys[mid].account, account);
+        if (cmp == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+
+    *found = 0;
+    return lo;
+}
+
+// Bind a key to an account. Registering the same key again is a no-op;
+// rebinding an account to another key returns BC_ERR_SIGNATURE.
+int register_account_key(KeyRegistry* registry, const char* account, const unsigned char public_key[PUBLIC_KEY_SIZE]) {
+    if (strlen(account) >= sizeof(registry->keys[0].account)) {
+        return BC_ERR_INVALID_ARG;
+    }
+
+    int found;
+    int pos = find_account_key(registry, account, &found);
+    if (found) {
+        return memcmp(registry->keys[pos].public_key, public_key, PUBLIC_KEY_SIZE) == 0 ? BC_OK : BC_ERR_SIGNATURE;
+    }
+
+    if (registry->count >= registry->capacity) {
+        AccountKey* keys = (AccountKey*)realloc(registry->keys, registry->capacity * 2 * sizeof(AccountKey));
+        if (keys == NULL) {
+            return BC_ERR_NOMEM;
+        }
+        registry->keys = keys;
+        registry->capacity *= 2;
+    }
+
+    memmove(&registry->keys[pos + 1], &registry->keys[pos], (registry->count - pos) * sizeof(AccountKey));
+    registry->count++;
+    strcpy(registry->keys[pos].account, account);
+    memcpy(registry->keys[pos].public_key, public_key, PUBLIC_KEY_SIZE);
+    return BC_OK;
+}
+
+// The key registered for the account, or NULL
+const unsigned char* lookup_account_key(const KeyRegistry* registry, const char* account) {
+    if (registry == NULL) {
+        return NULL;
+    }
+    int found;
+    int pos = find_account_key(registry, account, &found);
+    return found ? registry->keys[pos].public_key : NULL;
+}
+
+// Text file: "KEYS 1", "accounts N", then one "account public_key_hex" per line
+int save_key_registry(const KeyRegistry* registry, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return BC_ERR_IO;
+    }
+
+    fprintf(file, "KEYS 1\n");
+    fprintf(file, "accounts %d\n", registry->count);
+    for (int i = 0; i < registry->count; i++) {
+        char public_key[PUBLIC_KEY_SIZE * 2 + 1];
+        bytes_to_hex(registry->keys[i].public_key, PUBLIC_KEY_SIZE, public_key);
+        fprintf(file, "%s %s\n", registry->keys[i].account, public_key);
+    }
+
+    int failed = ferror(file);
+    if (fclose(file) != 0) failed = 1;
+    return failed ? BC_ERR_IO : BC_OK;
+}
+
+// Returns BC_OK, BC_ERR_IO if the file cannot be opened, BC_ERR_FORMAT or BC_ERR_NOMEM
+int load_key_registry(const char* path, KeyRegistry** out) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return BC_ERR_IO;
+    }
+
+    int version, count;
+    if (fscanf(file, "KEYS %d accounts %d", &version, &count) != 2 || version != 1 || count < 0) {
+        fclose(file);
+        return BC_ERR_FORMAT;
+    }
+
+    KeyRegistry* registry = create_key_registry();
+    if (registry == NULL) {
+        fclose(file);
+        return BC_ERR_NOMEM;
+    }
+
+    int status = BC_OK;
+    for (int i = 0; status == BC_OK && i < count; i++) {
+        char account[64], hex[PUBLIC_KEY_SIZE * 2 + 2];
+        unsigned char public_key[PUBLIC_KEY_SIZE];
+        if (fscanf(file, "%63s %65s", account, hex) != 2 || strlen(hex) != PUBLIC_KEY_SIZE * 2
+            || !hex_to_bytes(hex, public_key, PUBLIC_KEY_SIZE)) {
+            status = BC_ERR_FORMAT;
+            break;
+        }
+        status = register_account_key(registry, account, public_key);
+        if (status == BC_ERR_SIGNATURE) status = BC_ERR_FORMAT;
+    }
+    fclose(file);
+
+    if (status != BC_OK) {
+        free_key_registry(registry);
+        return status;
+    }
+    *out = registry;
+    return BC_OK;
+}
+
+int verify_transaction_signature(const Transaction* tx, const KeyRegistry* registry) {
+    if (!tx->has_signature || tx->nonce == 0) {
+        return 0;
+    }
+    const unsigned char* registered = lookup_account_key(registry, tx->sender);
+    if (registered == NULL || memcmp(registered, tx->public_key, PUBLIC_KEY_SIZE) != 0) {
+        return 0;
+    }
+
+    EVP_PKEY* key = EVP_PKEY_new_raw_public_key(EVP_PKEY_ED25519, NULL, tx->public_key, PUBLIC_KEY_SIZE);
+    if (key == NULL) {
+        return 0;
+    }
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    if (ctx == NULL) {
+        EVP_PKEY_free(key);
+        return 0;
+    }
+
+    char message[TX_STRING_SIZE];
+    transaction_message(tx, message, sizeof(message));
+
+    int valid = EVP_DigestVerifyInit(ctx, NULL, NULL, NULL, key) == 1
+             && EVP_DigestVerify(ctx, tx->signature, SIGNATURE_SIZE,
+                                 (const unsigned char*)message, strlen(message)) == 1;
+
+    EVP_MD_CTX_free(ctx);
+    EVP_PKEY_free(key);
+    return valid;
+}
+
+int verify_transaction_authorized(const Transaction* tx, const KeyRegistry* registry) {
+    if (tx->has_signature) {
+        return verify_transaction_signature(tx, registry);
+    }
+    return lookup_account_key(registry, tx->sender) == NULL;
+}
+
+typedef struct {
+    const Transaction** txs;
+    int* results;
+    const KeyRegistry* registry;
+    int from;
+    int to;
+    int require_signed;
+    int failures;
+} VerifyChunk;
+
+static void verify_chunk(void* arg) {
+    VerifyChunk* chunk = (VerifyChunk*)arg;
+
+    for (int i = chunk->from; i < chunk->to; i++) {
+        const Transaction* tx = chunk->txs[i];
+        int valid = (tx->has_signature || !chunk->require_signed) && verify_transaction_authorized(tx, chunk->registry);
+        chunk->results[i] = valid;
+        if (!valid) chunk->failures++;
+    }
+}
+
+int verify_signatures_batch(const Transaction** txs, int count, int require_signed,
+                            const KeyRegistry* registry, int* results, ThreadPool* pool) {
+    if (count <= 0) {
+        return 0;
+    }
+
+    // A few chunks per worker keeps them busy when signatures differ in cost
+    int chunk_count = pool != NULL ? thread_pool_size(pool) * 4 : 1;
+    if (chunk_count > count) chunk_count = count;
+
+    VerifyChunk* chunks = (VerifyChunk*)malloc(chunk_count * sizeof(VerifyChunk));
+    if (chunks == NULL) {
+        chunk_count = 1;
+    }
+    VerifyChunk single;
+    VerifyChunk* work = chunks != NULL ? chunks : &single;
+
+    for (int c = 0; c < chunk_count; c++) {
+        work[c].txs = txs;
+        work[c].results = results;
+        work[c].registry = registry;
+        work[c].from = (int)((long long)count * c / chunk_count);
+        work[c].to = (int)((long long)count * (c + 1) / chunk_count);
+        work[c].require_signed = require_signed;
+        work[c].failures = 0;
+
+        if (pool == NULL || chunk_count == 1 || thread_pool_submit(pool, verify_chunk, &work[c]) != BC_OK) {
+            verify_chunk(&work[c]);
+        }
+    }
+    if (pool != NULL && chunk_count > 1) {
+        thread_pool_wait(pool);
+    }
+
+    int failures = 0;
+    for (int c = 0; c < chunk_count; c++) {
+        failures += work[c].failures;
+    }
+
+    free(chunks);
+    return failures;
+}
+
+int verify_block_signatures(Block* block, int require_signed, const KeyRegistry* registry,
+                            int* results, ThreadPool* pool) {
+    if (is_block_pruned(block)) {
+        return 0;
+    }
+
+    const Transaction* txs[MAX_TRANSACTIONS];
+    for (int i = 0; i < block->transaction_count; i++) {
+        txs[i] = &block->transactions[i];
+    }
+    return verify_signatures_batch(txs, block->transaction_count, require_signed, registry, results, pool);
+}
+
+// Signed nonces must increase per sender along the chain, starting from the
+// nonces recorded in the pruning snapshot
+static int verify_chain_nonces(Blockchain* blockchain, int* first_invalid_block) {
+    StateSnapshot* nonces = blockchain->snapshot != NULL ? copy_snapshot(blockchain->snapshot) : alloc_snapshot(16);
+    if (nonces == NULL) {
+        return BC_ERR_NOMEM;
+    }
+
+    int start = blockchain->snapshot != NULL ? blockchain->snapshot->height : 0;
+    int status = BC_OK;
+    for (int i = start; status == BC_OK && i < blockchain->length; i++) {
+        Block* block = blockchain->blocks[i];
+        if (is_block_pruned(block)) continue;
+        for (int j = 0; status == BC_OK && j < block->transaction_count; j++) {
+            status = advance_nonce(nonces, &block->transactions[j]);
+        }
+        if (status == BC_ERR_REPLAY) {
+            log_message(BC_LOG_WARN, "Replayed nonce in block %d!", i);
+            if (first_invalid_block != NULL) *first_invalid_block = i;
+        }
+    }
+
+    free_snapshot(nonces);
+    return status;
+}
+
+// Check every signature still held in the chain in one batch, then the
+// nonces. The genesis block is exempt from require_signed. Returns BC_OK,
+// BC_ERR_SIGNATURE or BC_ERR_REPLAY (with the lowest offending block in
+// first_invalid_block) or BC_ERR_NOMEM.
+int verify_chain_signatures(Blockchain* blockchain, int require_signed, const KeyRegistry* registry,
+                            ThreadPool* pool, int* first_invalid_block) {
+    int count = 0;
+    for (int i = 1; i < blockchain->length; i++) {
+        if (!is_block_pruned(blockchain->blocks[i])) {
+            count += blockchain->blocks[i]->transaction_count;
+        }
+    }
+    if (first_invalid_block != NULL) *first_invalid_block = -1;
+    if (count == 0) {
+        return verify_chain_nonces(blockchain, first_invalid_block);
+    }
+
+    const Transaction** txs = (const Transaction**)malloc(count * sizeof(Transaction*));
+    int* owners = (int*)malloc(count * sizeof(int));
+    int* results = (int*)malloc(count * sizeof(int));
+    if (txs == NULL || owners == NULL || results == NULL) {
+        free(txs);
+        free(owners);
+        free(results);
+        return BC_ERR_NOMEM;
+    }
+
+    int n = 0;
+    for (int i = 1; i < blockchain->length; i++) {
+        Block* block = blockchain->blocks[i];
+        if (is_block_pruned(block)) continue;
+        for (int j = 0; j < block->transaction_count; j++) {
+            txs[n] = &block->transactions[j];
+            owners[n] = i;
+            n++;
+        }
+    }
+
+    int failures = verify_signatures_batch(txs, count, require_signed, registry, results, pool);
+    if (failures > 0) {
+        for (int i = 0; i < count; i++) {
+            if (!results[i]) {
+                log_message(BC_LOG_WARN, "Invalid signature in block %d!", owners[i]);
+                if (first_invalid_block != NULL) *first_invalid_block = owners[i];
+                break;
+            }
+        }
+    }
+
+    free(txs);
+    free(owners);
+    free(results);
+    if (failures > 0) {
+        return BC_ERR_SIGNATURE;
+    }
+    return verify_chain_nonces(blockchain, first_invalid_block);
+}
@@ -0,0 +1,59 @@
+#ifndef SIGNATURE_H
+#define SIGNATURE_H
+
+#include <openssl/evp.h>
+#include "blockchain.h"
+#include "thread_pool.h"
+
+#define KEY_SEED_SIZE 32
+
+typedef struct {
+    EVP_PKEY* key;
+    unsigned char public_key[PUBLIC_KEY_SIZE];
+} KeyPair;
+
+typedef struct {
+    char account[64];
+    unsigned char public_key[PUBLIC_KEY_SIZE];
+} AccountKey;
+
+// The public key each account signs with, sorted by account name. A signed
+// transaction is only valid under the key registered for its sender, and a
+// sender with a registered key can no longer send unsigned transactions.
+typedef struct KeyRegistry {
+    AccountKey* keys;
+    int count;
+    int capacity;
+} KeyRegistry;
+
+// Ed25519 keys and transaction signatures (OpenSSL libcrypto)
+int generate_keypair(KeyPair* keys);
+int keypair_from_seed(KeyPair* keys, const unsigned char seed[KEY_SEED_SIZE]);
+void free_keypair(KeyPair* keys);
+int sign_transaction(Transaction* tx, const KeyPair* keys);
+
+KeyRegistry* create_key_registry();
+void free_key_registry(KeyRegistry* registry);
+int register_account_key(KeyRegistry* registry, const char* account, const unsigned char public_key[PUBLIC_KEY_SIZE]);
+const unsigned char* lookup_account_key(const KeyRegistry* registry, const char* account);
+int save_key_registry(const KeyRegistry* registry, const char* path);
+int load_key_registry(const char* path, KeyRegistry** out);
+
+// 1 if the transaction is signed with a nonce, by the key registered for its
+// sender (a NULL registry has no keys), and the signature verifies
+int verify_transaction_signature(const Transaction* tx, const KeyRegistry* registry);
+// Same for signed transactions; an unsigned one passes if its sender has no key
+int verify_transaction_authorized(const Transaction* tx, const KeyRegistry* registry);
+
+// Batch verification, split across the pool (inline when pool is NULL).
+// results[i] is set to 1 for an authorized transaction; unsigned ones are
+// rejected when require_signed is set. Return the number of failures.
+// Nonces are not checked here: see advance_nonce() in snapshot.h.
+int verify_signatures_batch(const Transaction** txs, int count, int require_signed,
+                            const KeyRegistry* registry, int* results, ThreadPool* pool);
+int verify_block_signatures(Block* block, int require_signed, const KeyRegistry* registry,
+                            int* results, ThreadPool* pool);
+int verify_chain_signatures(Blockchain* blockchain, int require_signed, const KeyRegistry* registry,
+                            ThreadPool* pool, int* first_invalid_block);
+
+#endif
@@ -0,0 +1,377 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+#include "utils.h"
+#include "logger.h"
+#include "alloc.h"
+
+StateSnapshot* alloc_snapshot(int capacity) {
+    StateSnapshot* snapshot = (StateSnapshot*)tracked_malloc(MEM_TAG_SNAPSHOT, sizeof(StateSnapshot));
+    if (snapshot == NULL) {
+        return NULL;
+    }
+
+    if (capacity < 16) capacity = 16;
+    snapshot->balances = (AccountBalance*)tracked_malloc(MEM_TAG_SNAPSHOT, capacity * sizeof(AccountBalance));
+    if (snapshot->balances == NULL) {
+        tracked_free(snapshot);
+        return NULL;
+    }
+
+    snapshot->height = 0;
+    snapshot->block_hash[0] = '\0';
+    snapshot->count = 0;
+    snapshot->capacity = capacity;
+    return snapshot;
+}
+
+// Binary search; returns the slot of the account or the slot it should be inserted at
+static int find_account(const StateSnapshot* snapshot, const char* account, int* found) {
+    int lo = 0, hi = snapshot->count;
+
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(snapshot->balances[mid].account, account);
+        if (cmp == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+
+    *found = 0;
+    return lo;
+}
+
+static AccountBalance* get_or_insert(StateSnapshot* snapshot, const char* account) {
+    int found;
+    int pos = find_account(snapshot, account, &found);
+    if (found) {
+        return &snapshot->balances[pos];
+    }
+
+    if (snapshot->count >= snapshot->capacity) {
+        AccountBalance* balances = (AccountBalance*)tracked_realloc(MEM_TAG_SNAPSHOT, snapshot->balances, snapshot->capacity * 2 * sizeof(AccountBalance));
+        if (balances == NULL) {
+            return NULL;
+        }
+        snapshot->balances = balances;
+        snapshot->capacity *= 2;
+    }
+
+    memmove(&snapshot->balances[pos + 1], &snapshot->balances[pos],
+            (snapshot->count - pos) * sizeof(AccountBalance));
+    snapshot->count++;
+
+    AccountBalance* entry = &snapshot->balances[pos];
+    strncpy(entry->account, account, 63);
+    entry->account[63] = '\0';
+    entry->balance = 0;
+    entry->nonce = 0;
+    return entry;
+}
+
+// Build the balances at `height`, starting from the chain's own snapshot when
+// it lies below that height so already pruned bodies are not needed.
+// Returns NULL on failure, with the reason in *status when it is not NULL:
+// BC_ERR_INVALID_ARG for a height outside the chain, BC_ERR_PRUNED if a body
+// required for the replay has been pruned, BC_ERR_OVERFLOW if a balance
+// overflows, or BC_ERR_NOMEM.
+StateSnapshot* create_snapshot(Blockchain* blockchain, int height, int* status) {
+    if (status != NULL) *status = BC_OK;
+    if (height < 0 || height > blockchain->length) {
+        if (status != NULL) *status = BC_ERR_INVALID_ARG;
+        return NULL;
+    }
+
+    StateSnapshot* snapshot;
+    int start;
+    if (blockchain->snapshot != NULL && blockchain->snapshot->height <= height) {
+        snapshot = copy_snapshot(blockchain->snapshot);
+        start = blockchain->snapshot->height;
+    } else {
+        snapshot = alloc_snapshot(16);
+        start = 0;
+    }
+    if (snapshot == NULL) {
+        if (status != NULL) *status = BC_ERR_NOMEM;
+        return NULL;
+    }
+
+    int failure = BC_OK;
+    for (int i = start; failure == BC_OK && i < height; i++) {
+        Block* block = blockchain->blocks[i];
+        if (is_block_pruned(block)) {
+            failure = BC_ERR_PRUNED;
+            break;
+        }
+
+        for (int j = 0; j < block->transaction_count; j++) {
+            Transaction* tx = &block->transactions[j];
+            AccountBalance* sender = get_or_insert(snapshot, tx->sender);
+            if (sender == NULL) {
+                failure = BC_ERR_NOMEM;
+                break;
+            }
+            if (amount_sub(sender->balance, tx->amount, &sender->balance) != BC_OK) {
+                failure = BC_ERR_OVERFLOW;
+                break;
+            }
+            // Nonces are checked by verify and ingest; the replay only records them
+            if (tx->has_signature && tx->nonce > sender->nonce) {
+                sender->nonce = tx->nonce;
+            }
+
+            AccountBalance* receiver = get_or_insert(snapshot, tx->receiver);
+            if (receiver == NULL) {
+                failure = BC_ERR_NOMEM;
+                break;
+            }
+            if (amount_add(receiver->balance, tx->amount, &receiver->balance) != BC_OK) {
+                failure = BC_ERR_OVERFLOW;
+                break;
+            }
+        }
+    }
+    if (failure != BC_OK) {
+        free_snapshot(snapshot);
+        if (status != NULL) *status = failure;
+        return NULL;
+    }
+
+    snapshot->height = height;
+    if (height > 0) {
+        strcpy(snapshot->block_hash, blockchain->blocks[height - 1]->current_hash);
+    } else {
+        strcpy(snapshot->block_hash, "0");
+    }
+
+    return snapshot;
+}
+
+StateSnapshot* copy_snapshot(const StateSnapshot* snapshot) {
+    StateSnapshot* copy = alloc_snapshot(snapshot->capacity);
+    if (copy == NULL) {
+        return NULL;
+    }
+
+    copy->height = snapshot->height;
+    strcpy(copy->block_hash, snapshot->block_hash);
+    copy->count = snapshot->count;
+    memcpy(copy->balances, snapshot->balances, snapshot->count * sizeof(AccountBalance));
+
+    return copy;
+}
+
+void free_snapshot(StateSnapshot* snapshot) {
+    if (snapshot == NULL) return;
+
+    tracked_free(snapshot->balances);
+    tracked_free(snapshot);
+}
+
+amount_t get_balance(const StateSnapshot* snapshot, const char* account) {
+    int found;
+    int pos = find_account(snapshot, account, &found);
+    return found ? snapshot->balances[pos].balance : 0;
+}
+
+uint64_t get_nonce(const StateSnapshot* snapshot, const char* account) {
+    int found;
+    int pos = find_account(snapshot, account, &found);
+    return found ? snapshot->balances[pos].nonce : 0;
+}
+
+// Record the nonce of a signed transaction. Returns BC_ERR_REPLAY, leaving the
+// snapshot unchanged, unless it is above the last nonce of the sender.
+// Unsigned transactions carry no nonce and always pass.
+int advance_nonce(StateSnapshot* snapshot, const Transaction* tx) {
+    if (!tx->has_signature) {
+        return BC_OK;
+    }
+    if (tx->nonce <= get_nonce(snapshot, tx->sender)) {
+        return BC_ERR_REPLAY;
+    }
+
+    AccountBalance* sender = get_or_insert(snapshot, tx->sender);
+    if (sender == NULL) {
+        return BC_ERR_NOMEM;
+    }
+    sender->nonce = tx->nonce;
+    return BC_OK;
+}
+
+// Hash of the canonical "height:block_hash;account=balance;..." encoding,
+// stored in the snapshot file so a loading node can detect tampered balances.
+// Accounts with a nonce are written "account=balance/nonce;", so roots of
+// snapshots without nonces are unchanged.
+int calculate_state_root(const StateSnapshot* snapshot, char output[65]) {
+    size_t size = 128 + (size_t)snapshot->count * (64 + AMOUNT_STRING_SIZE + 24);
+    char* buffer = (char*)malloc(size);
+    if (buffer == NULL) {
+        output[0] = '\0';
+        return BC_ERR_NOMEM;
+    }
+
+    size_t offset = snprintf(buffer, size, "%d:%s;", snapshot->height, snapshot->block_hash);
+    for (int i = 0; i < snapshot->count; i++) {
+        char balance[AMOUNT_STRING_SIZE];
+        const AccountBalance* entry = &snapshot->balances[i];
+        format_amount(entry->balance, balance, sizeof(balance));
+        if (entry->nonce > 0) {
+            offset += snprintf(buffer + offset, size - offset, "%s=%s/%llu;", entry->account, balance,
+                               (unsigned long long)entry->nonce);
+        } else {
+            offset += snprintf(buffer + offset, size - offset, "%s=%s;", entry->account, balance);
+        }
+    }
+
+    sha256_hash(buffer, output);
+    free(buffer);
+    return BC_OK;
+}
+
+int save_snapshot(const StateSnapshot* snapshot, const char* path) {
+    char state_root[65];
+    if (calculate_state_root(snapshot, state_root) != BC_OK) {
+        return BC_ERR_NOMEM;
+    }
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return BC_ERR_IO;
+    }
+
+    fprintf(file, "SNAPSHOT 2\n");
+    fprintf(file, "height %d\n", snapshot->height);
+    fprintf(file, "block_hash %s\n", snapshot->block_hash);
+    fprintf(file, "state_root %s\n", state_root);
+    fprintf(file, "accounts %d\n", snapshot->count);
+    for (int i = 0; i < snapshot->count; i++) {
+        char balance[AMOUNT_STRING_SIZE];
+        fprintf(file, "%s %s %llu\n", snapshot->balances[i].account,
+                format_amount(snapshot->balances[i].balance, balance, sizeof(balance)),
+                (unsigned long long)snapshot->balances[i].nonce);
+    }
+
+    int failed = ferror(file);
+    if (fclose(file) != 0) failed = 1;
+    return failed ? BC_ERR_IO : BC_OK;
+}
+
+StateSnapshot* load_snapshot(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    int version, height, count;
+    char block_hash[65], state_root[65];
+
+    if (fscanf(file, "SNAPSHOT %d height %d block_hash %64s state_root %64s accounts %d",
+               &version, &height, block_hash, state_root, &count) != 5
+        || version < 1 || version > 2 || height < 0 || count < 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    StateSnapshot* snapshot = alloc_snapshot(count);
+    if (snapshot == NULL) {
+        fclose(file);
+        return NULL;
+    }
+    snapshot->height = height;
+    strcpy(snapshot->block_hash, block_hash);
+
+    for (int i = 0; i < count; i++) {
+        AccountBalance* entry = &snapshot->balances[i];
+        char balance[AMOUNT_STRING_SIZE];
+        unsigned long long nonce = 0;
+        if (fscanf(file, "%63s %31s", entry->account, balance) != 2
+            || (version >= 2 && fscanf(file, "%llu", &nonce) != 1)
+            || !parse_amount(balance, &entry->balance)) {
+            fclose(file);
+            free_snapshot(snapshot);
+            return NULL;
+        }
+        entry->nonce = nonce;
+        snapshot->count++;
+    }
+    fclose(file);
+
+    if (check_snapshot(snapshot, state_root) != BC_OK) {
+        free_snapshot(snapshot);
+        return NULL;
+    }
+
+    return snapshot;
+}
+
+// Checks a snapshot that comes from a file or a peer before its balances and
+// nonces are trusted: accounts strictly sorted (the lookups are binary
+// searches) and, when state_root is not NULL, matching that root. Returns
+// BC_OK, BC_ERR_FORMAT or BC_ERR_NOMEM.
+int check_snapshot(const StateSnapshot* snapshot, const char* state_root) {
+    for (int i = 1; i < snapshot->count; i++) {
+        if (strcmp(snapshot->balances[i - 1].account, snapshot->balances[i].account) >= 0) {
+            return BC_ERR_FORMAT;
+        }
+    }
+    if (state_root == NULL) {
+        return BC_OK;
+    }
+
+    char calculated_root[65];
+    if (calculate_state_root(snapshot, calculated_root) != BC_OK) {
+        return BC_ERR_NOMEM;
+    }
+    return strcmp(calculated_root, state_root) == 0 ? BC_OK : BC_ERR_FORMAT;
+}
+
+// 1 if the snapshot sits on block height-1 of the chain
+int is_snapshot_anchored(const StateSnapshot* snapshot, const Blockchain* blockchain) {
+    return snapshot->height >= 1 && snapshot->height <= blockchain->length
+        && strcmp(blockchain->blocks[snapshot->height - 1]->current_hash, snapshot->block_hash) == 0;
+}
+
+// Create a new node from a peer's chain and a snapshot instead of replaying
+// from genesis: blocks below the snapshot height are copied as headers only,
+// the remaining blocks in full. Returns NULL if the snapshot is not anchored
+// on the peer's chain or on allocation failure.
+Blockchain* bootstrap_from_snapshot(Blockchain* peer, const StateSnapshot* snapshot) {
+    if (!is_snapshot_anchored(snapshot, peer)) {
+        return NULL;
+    }
+
+    Blockchain* node = (Blockchain*)tracked_malloc(MEM_TAG_REPLICA, sizeof(Blockchain));
+    if (node == NULL) {
+        return NULL;
+    }
+
+    node->capacity = peer->capacity;
+    node->length = 0;
+    node->pruned_height = snapshot->height;
+    node->snapshot = copy_snapshot(snapshot);
+    node->blocks = (Block**)tracked_malloc(MEM_TAG_REPLICA, node->capacity * sizeof(Block*));
+    if (node->blocks == NULL || node->snapshot == NULL) {
+        free_blockchain(node);
+        return NULL;
+    }
+
+    for (int i = 0; i < peer->length; i++) {
+        if (i < snapshot->height) {
+            node->blocks[i] = copy_block_header(peer->blocks[i]);
+        } else {
+            node->blocks[i] = deep_copy_block(peer->blocks[i]);
+        }
+        if (node->blocks[i] == NULL) {
+            free_blockchain(node);
+            return NULL;
+        }
+        node->length++;
+    }
+
+    return node;
+}
@@ -0,0 +1,36 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "blockchain.h"
+
+typedef struct {
+    char account[64];
+    amount_t balance;
+    uint64_t nonce;         // Highest nonce the account has signed, 0 if none
+} AccountBalance;
+
+// Account balances after applying blocks [0, height). Entries are kept
+// sorted by account name so lookups are a binary search.
+typedef struct StateSnapshot {
+    int height;
+    char block_hash[65];    // current_hash of block height-1, anchors the snapshot to the chain
+    AccountBalance* balances;
+    int count;
+    int capacity;
+} StateSnapshot;
+
+StateSnapshot* alloc_snapshot(int capacity);
+StateSnapshot* create_snapshot(Blockchain* blockchain, int height, int* status);
+StateSnapshot* copy_snapshot(const StateSnapshot* snapshot);
+void free_snapshot(StateSnapshot* snapshot);
+amount_t get_balance(const StateSnapshot* snapshot, const char* account);
+uint64_t get_nonce(const StateSnapshot* snapshot, const char* account);
+int advance_nonce(StateSnapshot* snapshot, const Transaction* tx);
+int calculate_state_root(const StateSnapshot* snapshot, char output[65]);
+int save_snapshot(const StateSnapshot* snapshot, const char* path);
+StateSnapshot* load_snapshot(const char* path);
+int check_snapshot(const StateSnapshot* snapshot, const char* state_root);
+int is_snapshot_anchored(const StateSnapshot* snapshot, const Blockchain* blockchain);
+Blockchain* bootstrap_from_snapshot(Blockchain* peer, const StateSnapshot* snapshot);
+
+#endif
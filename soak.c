@@ -0,0 +1,225 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "soak.h"
+#include "block.h"
+#include "sealer.h"
+#include "codec.h"
+#include "logger.h"
+
+typedef struct {
+    double* samples;
+    long count;
+    long capacity;
+} LatencyLog;
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int record_latency(LatencyLog* log, double ms) {
+    if (log->count == log->capacity) {
+        long capacity = log->capacity > 0 ? log->capacity * 2 : 1024;
+        double* samples = (double*)realloc(log->samples, capacity * sizeof(double));
+        if (samples == NULL) {
+            return BC_ERR_NOMEM;
+        }
+        log->samples = samples;
+        log->capacity = capacity;
+    }
+    log->samples[log->count++] = ms;
+    return BC_OK;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentiles
+static void summarize_latency(LatencyLog* log, LatencySummary* summary) {
+    memset(summary, 0, sizeof(*summary));
+    summary->count = log->count;
+    if (log->count == 0) return;
+
+    qsort(log->samples, log->count, sizeof(double), compare_doubles);
+    summary->p50_ms = log->samples[(log->count - 1) * 50 / 100];
+    summary->p90_ms = log->samples[(log->count - 1) * 90 / 100];
+    summary->p99_ms = log->samples[(log->count - 1) * 99 / 100];
+    summary->max_ms = log->samples[log->count - 1];
+}
+
+void init_soak_config(SoakConfig* config) {
+    config->duration_seconds = 10;
+    config->max_blocks = 0;
+    config->block_size = MAX_TRANSACTIONS;
+    config->round_blocks = 100;
+    config->replicas = 2;
+    config->keep_depth = 1000;
+    config->body_codec = BODY_CODEC_PLAIN;
+    init_load_config(&config->load);
+}
+
+// Fill one block from the generator and hand it to the sealer. A block whose
+// transactions were all rejected is dropped instead of sealed.
+static int fill_and_submit(LoadGenerator* generator, Sealer* sealer, const SoakConfig* config,
+                           SoakReport* report, LatencyLog* fill, LatencyLog* submit) {
+    double start = now_ms();
+    Block* block = create_block(0, "");
+    if (block == NULL) {
+        return BC_ERR_NOMEM;
+    }
+    for (int i = 0; i < config->block_size; i++) {
+        char input[256];
+        if (next_transaction(generator, input, sizeof(input)) != BC_OK || append_transaction(block, input) != BC_OK) {
+            report->rejected++;
+            continue;
+        }
+        report->transactions++;
+    }
+    double filled = now_ms();
+    if (block->transaction_count == 0) {
+        free_block(block);
+        report->empty_blocks++;
+        return BC_OK;
+    }
+
+    int status = sealer_submit(sealer, block);
+    double submitted = now_ms();
+    if (status == BC_OK) status = record_latency(fill, filled - start);
+    if (status == BC_OK) status = record_latency(submit, submitted - filled);
+    report->blocks++;
+    return status;
+}
+
+// A peer receives only the timestamp and the encoded body of a block, and
+// rebuilds and hashes the block on top of its own tip
+static int rebuild_block(Blockchain* peer, time_t timestamp, const unsigned char* body, size_t size) {
+    Block* tip = peer->blocks[peer->length - 1];
+    Block* block = create_block(peer->length, tip->current_hash);
+    if (block == NULL) {
+        return BC_ERR_NOMEM;
+    }
+    block->timestamp = timestamp;
+
+    int status = decode_block_body(body, size, block);
+    if (status == BC_OK) status = calculate_block_hash(block);
+    if (status == BC_OK) status = add_block(peer, block);
+    if (status != BC_OK) {
+        free_block(block);
+    }
+    return status;
+}
+
+// Peers rebuild the round's blocks from their encoded bodies and verify only
+// those; a replica whose tip then differs from the primary's has diverged
+static int replicate_round(Blockchain* blockchain, Blockchain** peers, int replicas, int codec, int first,
+                           SoakReport* report, LatencyLog* replicate, LatencyLog* verify) {
+    double start = now_ms();
+    for (int i = first; i < blockchain->length; i++) {
+        Block* block = blockchain->blocks[i];
+        unsigned char body[BODY_MAX_ENCODED_SIZE];
+        size_t size;
+        int status = encode_block_body(block, codec, body, sizeof(body), &size);
+        for (int r = 0; status == BC_OK && r < replicas; r++) {
+            status = rebuild_block(peers[r], block->timestamp, body, size);
+        }
+        if (status != BC_OK) {
+            return status;
+        }
+    }
+    double replicated = now_ms();
+
+    const char* tip = blockchain->blocks[blockchain->length - 1]->current_hash;
+    int diverged = 0;
+    for (int r = 0; r < replicas; r++) {
+        if (!verify_blockchain_from(peers[r], first)) {
+            report->verification_failures++;
+        }
+        diverged |= strcmp(peers[r]->blocks[peers[r]->length - 1]->current_hash, tip) != 0;
+    }
+    report->divergences += diverged;
+    double verified = now_ms();
+
+    int status = record_latency(replicate, replicated - start);
+    if (status == BC_OK) status = record_latency(verify, verified - replicated);
+    return status;
+}
+
+int run_soak(Blockchain* blockchain, const SoakConfig* config, SoakReport* report) {
+    memset(report, 0, sizeof(*report));
+    if (config->block_size < 1 || config->block_size > MAX_TRANSACTIONS || config->round_blocks < 1
+        || config->replicas < 0 || (config->duration_seconds <= 0 && config->max_blocks <= 0)) {
+        return BC_ERR_INVALID_ARG;
+    }
+
+    LoadGenerator* generator = create_load_generator(&config->load);
+    if (generator == NULL) {
+        return BC_ERR_INVALID_ARG;
+    }
+    Blockchain** peers = (Blockchain**)calloc(config->replicas > 0 ? config->replicas : 1, sizeof(Blockchain*));
+    Sealer* sealer = create_sealer(blockchain, 0);
+    int status = peers != NULL && sealer != NULL ? BC_OK : BC_ERR_NOMEM;
+    for (int r = 0; status == BC_OK && r < config->replicas; r++) {
+        peers[r] = deep_copy_blockchain(blockchain);
+        if (peers[r] == NULL) status = BC_ERR_NOMEM;
+    }
+
+    LatencyLog fill = {0}, submit = {0}, seal = {0}, replicate = {0}, verify = {0};
+    double start = now_ms();
+    double deadline = config->duration_seconds > 0 ? start + config->duration_seconds * 1e3 : 0;
+
+    while (status == BC_OK) {
+        int first = blockchain->length;
+        int submitted = 0;
+        while (status == BC_OK && submitted < config->round_blocks
+               && (config->max_blocks <= 0 || report->blocks + report->empty_blocks < config->max_blocks)
+               && (deadline == 0 || now_ms() < deadline)) {
+            status = fill_and_submit(generator, sealer, config, report, &fill, &submit);
+            submitted++;
+        }
+        if (submitted == 0) break;
+
+        double flushing = now_ms();
+        int flushed = sealer_flush(sealer);
+        if (status == BC_OK) status = flushed;
+        if (status == BC_OK) status = record_latency(&seal, now_ms() - flushing);
+
+        // The sealer is idle until the next submit, so the chain can be read
+        if (status == BC_OK) {
+            status = replicate_round(blockchain, peers, config->replicas, config->body_codec, first, report, &replicate, &verify);
+        }
+        if (status == BC_OK && config->keep_depth > 0) {
+            int pruned = prune_blockchain(blockchain, config->keep_depth);
+            for (int r = 0; pruned >= 0 && r < config->replicas; r++) {
+                pruned = prune_blockchain(peers[r], config->keep_depth);
+            }
+            if (pruned < 0) status = pruned;
+        }
+        report->rounds++;
+    }
+
+    free_sealer(sealer);
+    report->elapsed_ms = now_ms() - start;
+    report->tx_per_second = report->elapsed_ms > 0 ? report->transactions * 1e3 / report->elapsed_ms : 0;
+    summarize_latency(&fill, &report->fill);
+    summarize_latency(&submit, &report->submit);
+    summarize_latency(&seal, &report->seal);
+    summarize_latency(&replicate, &report->replicate);
+    summarize_latency(&verify, &report->verify);
+
+    free(fill.samples);
+    free(submit.samples);
+    free(seal.samples);
+    free(replicate.samples);
+    free(verify.samples);
+    for (int r = 0; peers != NULL && r < config->replicas; r++) {
+        free_blockchain(peers[r]);
+    }
+    free(peers);
+    free_load_generator(generator);
+    return status;
+}
@@ -0,0 +1,53 @@
+#ifndef SOAK_H
+#define SOAK_H
+
+#include "blockchain.h"
+#include "loadgen.h"
+
+// Soak test: generated transactions are filled into blocks, sealed by a
+// Sealer, rebuilt by peer chains from the encoded bodies and verified there,
+// round after round, until the duration or the block limit is reached. Start
+// from init_soak_config().
+typedef struct {
+    double duration_seconds;
+    long max_blocks;           // 0 for no limit
+    int block_size;            // Transactions per block, up to MAX_TRANSACTIONS
+    int round_blocks;          // Blocks generated between replication and verification
+    int replicas;              // Peer chains kept in sync with the primary
+    int keep_depth;            // Prune bodies deeper than this after each round, 0 to keep all
+    int body_codec;            // BODY_CODEC_PLAIN or BODY_CODEC_DEFLATE for the bodies sent to replicas
+    LoadConfig load;
+} SoakConfig;
+
+typedef struct {
+    long count;
+    double p50_ms;
+    double p90_ms;
+    double p99_ms;
+    double max_ms;
+} LatencySummary;
+
+typedef struct {
+    long transactions;
+    long rejected;             // Generated transactions that failed to parse
+    long blocks;
+    long empty_blocks;         // Generated blocks left without transactions, not sealed
+    long rounds;
+    long divergences;          // Rounds where a replica's tip differed from the primary's
+    long verification_failures;
+    double elapsed_ms;
+    double tx_per_second;
+    LatencySummary fill;       // Generating and parsing one block of transactions
+    LatencySummary submit;     // Handing a block to the sealer, backpressure included
+    LatencySummary seal;       // Waiting at the end of a round for the sealer to finish
+    LatencySummary replicate;  // Rebuilding a round's blocks on every replica from their encoded bodies
+    LatencySummary verify;     // Verifying the round's blocks on every replica
+} SoakReport;
+
+void init_soak_config(SoakConfig* config);
+
+// Runs on `blockchain`, which grows by the sealed blocks. Returns BC_OK or the
+// first error; the report covers the rounds completed so far.
+int run_soak(Blockchain* blockchain, const SoakConfig* config, SoakReport* report);
+
+#endif
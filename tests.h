@@ -8,6 +8,15 @@ void test_nominal_operations(Blockchain* blockchain);
 void test_update_delete(Blockchain* blockchain);
 void test_malicious_behavior(Blockchain* blockchain);
 void test_availability(Blockchain* blockchain);
+void test_pruning(Blockchain* blockchain);
+void test_signed_transactions(Blockchain* blockchain);
+void test_account_history(Blockchain* blockchain);
+void test_query_engine(Blockchain* blockchain);
+void test_columnar_export(Blockchain* blockchain);
+void test_fixed_point_amounts();
+void test_async_sealing(Blockchain* blockchain);
+void test_memory_accounting(Blockchain* blockchain);
+void test_soak_harness(Blockchain* blockchain);
 void attempt_transaction_modification(Blockchain* blockchain, int block_index, int tx_index);
 
 #endif
@@ -0,0 +1,162 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+#include "logger.h"
+
+typedef struct {
+    TaskFunction function;
+    void* arg;
+} Task;
+
+struct ThreadPool {
+    pthread_t* threads;
+    int thread_count;
+
+    // Circular task queue, grown on demand
+    Task* tasks;
+    int capacity;
+    int head;
+    int count;
+
+    int active;        // Tasks taken from the queue and still running
+    int shutting_down;
+
+    pthread_mutex_t lock;
+    pthread_cond_t task_available;
+    pthread_cond_t all_done;
+};
+
+static void* worker_main(void* arg) {
+    ThreadPool* pool = (ThreadPool*)arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->count == 0 && !pool->shutting_down) {
+            pthread_cond_wait(&pool->task_available, &pool->lock);
+        }
+        if (pool->count == 0 && pool->shutting_down) {
+            break;
+        }
+
+        Task task = pool->tasks[pool->head];
+        pool->head = (pool->head + 1) % pool->capacity;
+        pool->count--;
+        pool->active++;
+        pthread_mutex_unlock(&pool->lock);
+
+        task.function(task.arg);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->active--;
+        if (pool->count == 0 && pool->active == 0) {
+            pthread_cond_broadcast(&pool->all_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+int default_thread_count() {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+ThreadPool* create_thread_pool(int threads) {
+    if (threads < 1) threads = default_thread_count();
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (pool == NULL) {
+        return NULL;
+    }
+
+    pool->capacity = 64;
+    pool->tasks = (Task*)malloc(pool->capacity * sizeof(Task));
+    pool->threads = (pthread_t*)malloc(threads * sizeof(pthread_t));
+    if (pool->tasks == NULL || pool->threads == NULL) {
+        free(pool->tasks);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->task_available, NULL);
+    pthread_cond_init(&pool->all_done, NULL);
+
+    for (int i = 0; i < threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, worker_main, pool) != 0) {
+            break;
+        }
+        pool->thread_count++;
+    }
+    if (pool->thread_count == 0) {
+        free_thread_pool(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+int thread_pool_submit(ThreadPool* pool, TaskFunction function, void* arg) {
+    pthread_mutex_lock(&pool->lock);
+
+    if (pool->count == pool->capacity) {
+        Task* tasks = (Task*)malloc(pool->capacity * 2 * sizeof(Task));
+        if (tasks == NULL) {
+            pthread_mutex_unlock(&pool->lock);
+            return BC_ERR_NOMEM;
+        }
+        for (int i = 0; i < pool->count; i++) {
+            tasks[i] = pool->tasks[(pool->head + i) % pool->capacity];
+        }
+        free(pool->tasks);
+        pool->tasks = tasks;
+        pool->head = 0;
+        pool->capacity *= 2;
+    }
+
+    int tail = (pool->head + pool->count) % pool->capacity;
+    pool->tasks[tail].function = function;
+    pool->tasks[tail].arg = arg;
+    pool->count++;
+
+    pthread_cond_signal(&pool->task_available);
+    pthread_mutex_unlock(&pool->lock);
+    return BC_OK;
+}
+
+// Block until every submitted task has finished
+void thread_pool_wait(ThreadPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->count > 0 || pool->active > 0) {
+        pthread_cond_wait(&pool->all_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int thread_pool_size(const ThreadPool* pool) {
+    return pool->thread_count;
+}
+
+// Runs the queued tasks to completion, then joins the workers
+void free_thread_pool(ThreadPool* pool) {
+    if (pool == NULL) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutting_down = 1;
+    pthread_cond_broadcast(&pool->task_available);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->task_available);
+    pthread_cond_destroy(&pool->all_done);
+    free(pool->tasks);
+    free(pool->threads);
+    free(pool);
+}
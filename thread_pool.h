@@ -0,0 +1,16 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+typedef void (*TaskFunction)(void* arg);
+
+typedef struct ThreadPool ThreadPool;
+
+// Fixed-size pool of worker threads consuming a FIFO task queue
+ThreadPool* create_thread_pool(int threads);
+int thread_pool_submit(ThreadPool* pool, TaskFunction function, void* arg);
+void thread_pool_wait(ThreadPool* pool);
+int thread_pool_size(const ThreadPool* pool);
+void free_thread_pool(ThreadPool* pool);
+int default_thread_count();
+
+#endif
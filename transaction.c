@@ -1,37 +1,117 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include "transaction.h"
 #include "utils.h"
+#include "metrics.h"
+#include "signature.h"
 
+// The part of a transaction covered by its signature. The nonce is only
+// written when set, so unsigned transactions keep their former encoding.
+void transaction_message(const Transaction* tx, char* output, size_t size) {
+    char amount[AMOUNT_STRING_SIZE];
+    int length = snprintf(output, size, "%s sends %s DA to %s", tx->sender, format_amount(tx->amount, amount, sizeof(amount)), tx->receiver);
+    if (tx->nonce > 0 && length >= 0 && (size_t)length < size) {
+        snprintf(output + length, size - length, " nonce:%llu", (unsigned long long)tx->nonce);
+    }
+}
+
+// Merkle leaf encoding: the message, followed by the public key and the
+// signature for signed transactions so that both are committed to the root
 void transaction_to_string(Transaction* tx, char* output, size_t size) {
-    snprintf(output, size, "%s sends %d DA to %s", tx->sender, tx->amount, tx->receiver);
+    if (!tx->has_signature) {
+        transaction_message(tx, output, size);
+        return;
+    }
+
+    char message[TX_STRING_SIZE];
+    char public_key[PUBLIC_KEY_SIZE * 2 + 1];
+    char signature[SIGNATURE_SIZE * 2 + 1];
+    transaction_message(tx, message, sizeof(message));
+    bytes_to_hex(tx->public_key, PUBLIC_KEY_SIZE, public_key);
+    bytes_to_hex(tx->signature, SIGNATURE_SIZE, signature);
+    snprintf(output, size, "%s pk:%s sig:%s", message, public_key, signature);
+}
+
+// Optional " nonce:<n>" field, n >= 1
+static int parse_nonce(const char* input, Transaction* tx) {
+    const char* nonce = strstr(input, " nonce:");
+    tx->nonce = 0;
+    if (nonce == NULL) {
+        return 1;
+    }
+
+    char* end;
+    errno = 0;
+    unsigned long long value = strtoull(nonce + 7, &end, 10);
+    if (nonce[7] < '0' || nonce[7] > '9' || errno != 0 || value == 0 || (*end != '\0' && *end != ' ')) {
+        return 0;
+    }
+    tx->nonce = value;
+    return 1;
+}
+
+// Optional " pk:<64 hex> sig:<128 hex>" suffix of a signed transaction
+static int parse_signature(const char* input, Transaction* tx) {
+    const char* public_key = strstr(input, " pk:");
+    const char* signature = strstr(input, " sig:");
+
+    if (public_key == NULL && signature == NULL) {
+        tx->has_signature = 0;
+        return 1;
+    }
+    if (public_key == NULL || signature == NULL
+        || !hex_to_bytes(public_key + 4, tx->public_key, PUBLIC_KEY_SIZE)
+        || !hex_to_bytes(signature + 5, tx->signature, SIGNATURE_SIZE)) {
+        return 0;
+    }
+
+    tx->has_signature = 1;
+    return 1;
 }
 
 int parse_transaction(const char* input, Transaction* tx) {
-    char temp[256];
-    strncpy(temp, input, 255);
-    temp[255] = '\0';
+    METRIC_TIMER_START(timer);
+    char temp[TX_STRING_SIZE];
+    strncpy(temp, input, TX_STRING_SIZE - 1);
+    temp[TX_STRING_SIZE - 1] = '\0';
 
     // Make lowercase copy for parsing
     char* lower = to_lowercase_copy(temp);
-    if (!lower) return 0;
+    if (!lower) {
+        METRIC_INC(METRIC_TX_REJECTED);
+        return 0;
+    }
 
-    char sender[64], receiver[64];
-    int amount;
+    char sender[64], receiver[64], amount_text[AMOUNT_STRING_SIZE];
+    amount_t amount;
 
-    int success = sscanf(lower, "%63s sends %d da to %63s", sender, &amount, receiver);
+    int success = sscanf(lower, "%63s sends %31s da to %63s", sender, amount_text, receiver);
     free(lower);
 
-    if (success == 3 && amount > 0) {
+    // Amounts are checked: no overflow, no more decimals than the fixed point holds
+    if (success == 3 && parse_amount(amount_text, &amount) && amount > 0
+        && parse_nonce(input, tx) && parse_signature(input, tx)) {
         // Copy original names from input string to preserve casing
-        sscanf(input, "%63s sends %d DA to %63s", tx->sender, &tx->amount, tx->receiver);
+        sscanf(input, "%63s sends %*s DA to %63s", tx->sender, tx->receiver);
+        tx->amount = amount;
+        METRIC_INC(METRIC_TX_PARSED);
+        METRIC_TIMER_STOP(timer, METRIC_HIST_TX_PARSE);
         return 1;
     }
 
+    METRIC_INC(METRIC_TX_REJECTED);
+    METRIC_TIMER_STOP(timer, METRIC_HIST_TX_PARSE);
     return 0;
 }
 
-int validate_transaction(const char* transaction) {
-    return (strstr(transaction, "sends") && strstr(transaction, "DA"));
+// A transaction is valid if it parses and its signature matches the key
+// registered for its sender; senders without a key may send unsigned
+int validate_transaction(const char* transaction, const struct KeyRegistry* registry) {
+    Transaction tx;
+    if (!parse_transaction(transaction, &tx)) {
+        return 0;
+    }
+    return verify_transaction_authorized(&tx, registry);
 }
@@ -1,14 +1,29 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include "amount.h"
+
+#define PUBLIC_KEY_SIZE 32   // Ed25519 public key
+#define SIGNATURE_SIZE 64    // Ed25519 signature
+#define TX_STRING_SIZE 512   // Room for a signed transaction's Merkle leaf
+
+struct KeyRegistry;
+
 typedef struct {
     char sender[64];
     char receiver[64];
-    int amount;
+    amount_t amount;
+    uint64_t nonce;        // Per-sender sequence number, covered by the signature; 0 if none
+    int has_signature;
+    unsigned char public_key[PUBLIC_KEY_SIZE];
+    unsigned char signature[SIGNATURE_SIZE];
 } Transaction;
 
 int parse_transaction(const char* input, Transaction* tx);
+void transaction_message(const Transaction* tx, char* output, size_t size);
 void transaction_to_string(Transaction* tx, char* output, size_t size);
-int validate_transaction(const char* transaction);
+int validate_transaction(const char* transaction, const struct KeyRegistry* registry);
 
 #endif
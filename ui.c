@@ -5,6 +5,47 @@
 #include "ui.h"
 #include "blockchain.h"
 #include "block.h"
+#include "metrics.h"
+#include "logger.h"
+#include "tests.h"
+
+// Core library messages are printed on the console like the menu output
+void console_log(LogLevel level, const char* message, void* user_data) {
+    (void)user_data;
+    if (level >= BC_LOG_ERROR) {
+        fprintf(stderr, "%s\n", message);
+    } else {
+        printf("%s\n", message);
+    }
+}
+
+void display_block(Block* block) {
+    char time_str[30];
+    struct tm *timeinfo;
+    timeinfo = localtime(&block->timestamp);
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", timeinfo);
+    
+    printf("\n=== BLOCK #%d ===\n", block->index);
+    printf("Timestamp: %s\n", time_str);
+    printf("Previous Hash: %s\n", block->previous_hash);
+    printf("Merkle Root: %s\n", block->merkle_root);
+    printf("Current Hash: %s\n", block->current_hash);
+    if (is_block_pruned(block)) {
+        printf("Transactions (%d): body pruned\n", block->transaction_count);
+        printf("================\n");
+        return;
+    }
+    printf("Transactions (%d):\n", block->transaction_count);
+    for (int i = 0; i < block->transaction_count; i++) {
+        Transaction* tx = &block->transactions[i];
+        char amount[AMOUNT_STRING_SIZE];
+        printf("  %d. %s sends %s DA to %s%s\n", i+1, tx->sender,
+               format_amount(tx->amount, amount, sizeof(amount)), tx->receiver,
+               tx->has_signature ? " [signed]" : "");
+    }
+    
+    printf("================\n");
+}
 
 void display_menu() {
     printf("\n===== BLOCKCHAIN DEMO =====\n");
@@ -14,12 +55,15 @@ void display_menu() {
     printf("4. Verify blockchain integrity\n");
     printf("5. Simulate attack\n");
     printf("6. Run automated tests\n");
+    printf("7. Prune old block bodies\n");
+    printf("8. Dump metrics\n");
+    printf("9. Account history\n");
     printf("0. Exit\n");
     printf("Enter your choice: ");
 }
 
 void handle_add_transaction(Blockchain* blockchain) {
-    char transaction[256];
+    char transaction[TX_STRING_SIZE];
     
     printf("\nEnter transaction (format: 'Sender sends Amount DA to Receiver'): ");
     fflush(stdin);
@@ -29,9 +73,9 @@ void handle_add_transaction(Blockchain* blockchain) {
     transaction[strcspn(transaction, "\n")] = 0;
     
     Block* current_block = blockchain->blocks[blockchain->length - 1];
-    add_transaction(current_block, transaction);
-    
-    printf("Transaction added to block #%d\n", current_block->index);
+    if (add_transaction(current_block, transaction) == BC_OK) {
+        printf("Transaction added to block #%d\n", current_block->index);
+    }
 }
 
 void handle_create_block(Blockchain* blockchain) {
@@ -43,7 +87,11 @@ void handle_create_block(Blockchain* blockchain) {
     }
     
     Block* new_block = create_block(blockchain->length, last_block->current_hash);
-    add_block(blockchain, new_block);
+    if (new_block == NULL || add_block(blockchain, new_block) != BC_OK) {
+        printf("\nMemory allocation error, block not created.\n");
+        free_block(new_block);
+        return;
+    }
     
     printf("\nNew block #%d created and added to the blockchain.\n", new_block->index);
 }
@@ -81,6 +129,76 @@ void handle_simulate_attack(Blockchain* blockchain) {
     attempt_transaction_modification(blockchain, block_index, tx_index);
 }
 
+void handle_prune_blockchain(Blockchain* blockchain) {
+    int keep_depth;
+    
+    printf("\nNumber of most recent blocks to keep in full: ");
+    if (scanf("%d", &keep_depth) != 1) {
+        printf("Invalid depth.\n");
+        return;
+    }
+    
+    int pruned = prune_blockchain(blockchain, keep_depth);
+    if (pruned < 0) {
+        printf("Pruning failed: %s\n", status_string(pruned));
+        return;
+    }
+    printf("Pruned %d block bodies. Headers are kept for all %d blocks.\n", pruned, blockchain->length);
+}
+
+void handle_dump_metrics() {
+    char path[256];
+    
+    printf("\nOutput file (leave empty for console): ");
+    if (fgets(path, sizeof(path), stdin) == NULL) {
+        return;
+    }
+    path[strcspn(path, "\n")] = 0;
+    
+    if (path[0] == '\0') {
+        metrics_write(stdout);
+    } else if (metrics_dump_file(path)) {
+        printf("Metrics written to %s\n", path);
+    } else {
+        printf("Could not write metrics to %s\n", path);
+    }
+}
+
+void handle_account_history(Blockchain* blockchain) {
+    char account[64];
+    
+    printf("\nAccount name: ");
+    if (fgets(account, sizeof(account), stdin) == NULL) {
+        return;
+    }
+    account[strcspn(account, "\n")] = 0;
+    
+    int* indices = (int*)malloc(blockchain->length * sizeof(int));
+    if (indices == NULL) {
+        printf("Out of memory.\n");
+        return;
+    }
+    int found = find_account_blocks(blockchain, account, indices, blockchain->length);
+    
+    printf("%s appears in %d of %d blocks.\n", account, found, blockchain->length);
+    for (int i = 0; i < found; i++) {
+        Block* block = blockchain->blocks[indices[i]];
+        if (is_block_pruned(block)) {
+            printf("  Block #%d: body pruned\n", block->index);
+            continue;
+        }
+        for (int j = 0; j < block->transaction_count; j++) {
+            Transaction* tx = &block->transactions[j];
+            if (strcmp(tx->sender, account) == 0 || strcmp(tx->receiver, account) == 0) {
+                char amount[AMOUNT_STRING_SIZE];
+                printf("  Block #%d: %s sends %s DA to %s\n", block->index, tx->sender,
+                       format_amount(tx->amount, amount, sizeof(amount)), tx->receiver);
+            }
+        }
+    }
+    free(indices);
+}
+
 void run_ui(Blockchain* blockchain) {
     int choice;
     
@@ -108,6 +226,15 @@ void run_ui(Blockchain* blockchain) {
             case 6:
                 run_interaction_tests();
                 break;
+            case 7:
+                handle_prune_blockchain(blockchain);
+                break;
+            case 8:
+                handle_dump_metrics();
+                break;
+            case 9:
+                handle_account_history(blockchain);
+                break;
             case 0:
                 printf("SimpleBlockChain session terminated successfully.\n");
 
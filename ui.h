@@ -4,6 +4,10 @@
 
 #include "blockchain.h"
 
+#include "logger.h"
+
+void console_log(LogLevel level, const char* message, void* user_data);
+void display_block(Block* block);
 void run_ui(Blockchain* blockchain);
 void display_menu();
 void handle_add_transaction(Blockchain* blockchain);
@@ -11,5 +15,8 @@ void handle_create_block(Blockchain* blockchain);
 void handle_view_blockchain(Blockchain* blockchain);
 void handle_verify_integrity(Blockchain* blockchain);
 void handle_simulate_attack(Blockchain* blockchain);
+void handle_prune_blockchain(Blockchain* blockchain);
+void handle_dump_metrics();
+void handle_account_history(Blockchain* blockchain);
 
 #endif
@@ -4,18 +4,46 @@
 #include <ctype.h>
 #include <openssl/sha.h>
 #include "utils.h"
+#include "metrics.h"
 
 void sha256_hash(const char* input, char output[65]) {
     unsigned char hash[SHA256_DIGEST_LENGTH];
     SHA256_CTX sha256;
+    METRIC_INC(METRIC_HASHES_COMPUTED);
     SHA256_Init(&sha256);
     SHA256_Update(&sha256, input, strlen(input));
     SHA256_Final(hash, &sha256);
     
-    for(int i = 0; i < SHA256_DIGEST_LENGTH; i++) {
-        sprintf(output + (i * 2), "%02x", hash[i]);
+    bytes_to_hex(hash, SHA256_DIGEST_LENGTH, output);
+}
+
+// Writes 2*size hex digits and a terminating NUL
+void bytes_to_hex(const unsigned char* bytes, size_t size, char* output) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < size; i++) {
+        output[i * 2] = digits[bytes[i] >> 4];
+        output[i * 2 + 1] = digits[bytes[i] & 0x0f];
+    }
+    output[size * 2] = '\0';
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decodes exactly 2*size hex digits; returns 1 on success, 0 otherwise
+int hex_to_bytes(const char* hex, unsigned char* output, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        int high = hex_value(hex[i * 2]);
+        if (high < 0) return 0;
+        int low = hex_value(hex[i * 2 + 1]);
+        if (low < 0) return 0;
+        output[i] = (unsigned char)((high << 4) | low);
     }
-    output[64] = '\0';
+    return 1;
 }
 
 char* to_lowercase_copy(const char* input) {
@@ -1,7 +1,11 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stddef.h>
+
 void sha256_hash(const char* input, char output[65]);
 char* to_lowercase_copy(const char* input);
+void bytes_to_hex(const unsigned char* bytes, size_t size, char* output);
+int hex_to_bytes(const char* hex, unsigned char* output, size_t size);
 
 #endif